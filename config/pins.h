@@ -1,7 +1,7 @@
 #ifndef PINS_H
 #define PINS_H
 
-// LCD pins (BCM GPIO numbers)
+// LCD pins (BCM GPIO numbers); further panels (--lcd) share RS/D4-D7 and bring their own E
 #define PIN_LCD_RS  26
 #define PIN_LCD_E   19
 #define PIN_LCD_D4  13
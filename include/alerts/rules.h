@@ -0,0 +1,66 @@
+#ifndef ALERTS_RULES_H
+#define ALERTS_RULES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "hardware_stats.h"
+
+/*
+ * Threshold rules over stat_fields() metrics, one per line:
+ *
+ *   name: field op value[:clear] [and field op value[:clear]]...
+ *         [for N] [hold N] [cooldown N] [-> exec:command | -> fifo:path]
+ *
+ *   cpu_hot:  temp > 75:70 for 30 -> exec:/usr/local/bin/notify
+ *   mem_low:  mem.used_percent > 95:90 and psi.memory.some10 > 10 for 5 -> fifo:/run/hw_alerts
+ *
+ * op is one of > >= < <= == !=. A rule starts firing once every term
+ * holds for "for" seconds and stops when a term no longer holds against
+ * its clear value (default: the threshold itself), but not before it has
+ * fired for "hold" seconds. Hooks run at most once per "cooldown" seconds.
+ * Durations accept an s/m/h suffix. '#' at the start of a line or after
+ * whitespace starts a comment, except in the hook argument, which runs to
+ * the end of the line.
+ */
+
+#define RULE_NAME_MAX 32
+
+typedef struct RuleAlert {
+    char     name[RULE_NAME_MAX];
+    char     field[32];         // first term, what the LCD shows
+    char     op[3];
+    double   threshold;
+    double   value;
+    uint64_t since_ns;
+} RuleAlert;
+
+/**
+ * Parse and compile a rules file. Bad lines are reported on stderr and
+ * skipped. Replaces previously loaded rules.
+ * @return number of rules compiled, -1 hata (file unreadable)
+ */
+int rules_load(const char* path);
+
+/**
+ * Re-evaluate the rules whose input fields changed since the last call,
+ * plus those waiting on a for/hold timer. Fires hooks on transitions.
+ */
+void rules_evaluate(const HardwareStats* s, uint64_t now_ns);
+
+size_t rules_count(void);
+
+// currently firing rules, newest first; returns how many were written
+size_t rules_firing(RuleAlert* out, size_t max);
+
+/**
+ * The newest firing alert nobody has acknowledged yet.
+ * @return 1 if out was filled, 0 if nothing to flash
+ */
+int rules_flash(RuleAlert* out);
+
+// stop flashing the alerts that are firing now
+void rules_acknowledge(void);
+
+void rules_deinit(void);
+
+#endif
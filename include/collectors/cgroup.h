@@ -0,0 +1,56 @@
+#ifndef COLLECTORS_CGROUP_H
+#define COLLECTORS_CGROUP_H
+
+#include <stddef.h>
+
+#define CGROUP_NAME_MAX 32
+
+// one cgroup v2 directory; rates are per second since the previous sample
+typedef struct CgroupStats {
+    char   name[CGROUP_NAME_MAX];   // last path component, truncated
+    double cpu_percent;             // of one core
+    unsigned long long memory_current;  // bytes, 0 without the memory controller
+    unsigned long long oom;         // memory.events counters (cumulative)
+    unsigned long long oom_kill;
+    unsigned long long mem_high;
+    unsigned long long mem_max;
+    double io_read_bytes_per_s;
+    double io_write_bytes_per_s;
+    double psi_cpu_some_avg10;
+    double psi_memory_some_avg10;
+    double psi_io_some_avg10;
+} CgroupStats;
+
+/**
+ * Walk the cgroup v2 hierarchy once and start watching it with inotify.
+ * Called lazily by cgroup_sample(); call it directly to pick another root.
+ * @param root  NULL -> /sys/fs/cgroup (or /sys/fs/cgroup/unified on hybrid setups)
+ * @return 0 başarı, -1 hata (no cgroup v2 mounted)
+ */
+int cgroup_init(const char* root);
+
+/**
+ * Apply pending create/remove events and read every tracked cgroup.
+ * @param top_out    cgroup with the highest CPU usage (may be NULL)
+ * @param count_out  number of tracked cgroups (may be NULL)
+ * @return 0 başarı, -1 hata
+ */
+int cgroup_sample(CgroupStats* top_out, size_t* count_out);
+
+/**
+ * Stats of every tracked cgroup from the last cgroup_sample().
+ * @return number of entries written to out (at most max)
+ */
+size_t cgroup_snapshot(CgroupStats* out, size_t max);
+
+void cgroup_deinit(void);
+
+/**
+ * --bench-cgroup N: create N empty cgroups under the root, time the tick
+ * that picks them up, the steady-state ticks and the tick that drops them
+ * again, then remove them. Needs write access to the cgroup v2 root.
+ * @return 0 başarı, 1 hata
+ */
+int cgroup_benchmark(unsigned n);
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef COLLECTORS_CPU_BURST_H
+#define COLLECTORS_CPU_BURST_H
+
+#include <stdint.h>
+#include "hardware_stats.h"
+
+/*
+ * Burst mode: a sampler thread reads per-core /proc/stat at 100-1000 Hz
+ * into a lock-free single-producer/single-consumer ring. A consumer
+ * thread turns consecutive samples into per-core utilisation over short
+ * slices and folds each window of slices into min/max/percentiles; the
+ * raw samples are dropped once consumed.
+ *
+ * /proc/stat counts in USER_HZ ticks (10 ms), so a slice shorter than a
+ * few ticks only says busy/idle; the high sample rate keeps slice
+ * boundaries within a millisecond of wall time.
+ */
+
+#define CPU_BURST_MAX_CORES HW_MAX_CORES
+
+// sampler CPU budget; above it the sample rate is lowered (never below 100 Hz)
+#define CPU_BURST_BUDGET_PERCENT 1.0
+
+typedef struct CpuBurstCore {
+    float min, max, mean;       // busy % over slices of the window
+    float p50, p95, p99;
+} CpuBurstCore;
+
+typedef struct CpuBurstWindow {
+    uint64_t end_ns;            // CLOCK_MONOTONIC
+    unsigned window_ms, slice_ms;
+    unsigned slices;            // slices folded into this window
+    unsigned core_count;
+    CpuBurstCore core[CPU_BURST_MAX_CORES];
+    int      hottest_core;      // highest p99, -1 if none
+} CpuBurstWindow;
+
+typedef struct CpuBurstOverhead {
+    unsigned target_hz;
+    unsigned effective_hz;          // target, or lower while over budget
+    double   actual_hz;
+    double   sampler_cpu_percent;   // of one core, sampler thread only
+    double   consumer_cpu_percent;
+    double   read_us;               // mean cost of one /proc/stat read + parse
+    uint64_t samples;
+    uint64_t dropped;               // ring full, consumer behind
+    uint64_t missed_ticks;          // sampler woke up too late for a tick
+} CpuBurstOverhead;
+
+/**
+ * Start the sampler and consumer threads.
+ * @param hz         100..1000
+ * @param slice_ms   utilisation granularity (>= 10)
+ * @param window_ms  how often a CpuBurstWindow is published
+ * @return 0 başarı, -1 hata
+ */
+int  cpu_burst_start(unsigned hz, unsigned slice_ms, unsigned window_ms);
+
+int  cpu_burst_running(void);
+
+/**
+ * Copy the last published window.
+ * @return 0 başarı, -1 no window yet / not running
+ */
+int  cpu_burst_latest(CpuBurstWindow* out);
+
+// over the last published window
+void cpu_burst_overhead(CpuBurstOverhead* out);
+
+void cpu_burst_stop(void);
+
+#endif
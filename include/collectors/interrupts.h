@@ -0,0 +1,50 @@
+#ifndef COLLECTORS_INTERRUPTS_H
+#define COLLECTORS_INTERRUPTS_H
+
+#include <stddef.h>
+
+#define IRQ_NAME_MAX 16
+
+typedef enum {
+    IRQ_SRC_HARD = 0,   // /proc/interrupts
+    IRQ_SRC_SOFT,       // /proc/softirqs
+    IRQ_SRC_COUNT
+} IrqSource;
+
+typedef struct IrqSummary {
+    double irq_total_per_s;         // every row of /proc/interrupts
+    double softirq_total_per_s;
+    char   hottest_irq[IRQ_NAME_MAX];   // busiest device IRQ (numeric rows only)
+    double hottest_irq_per_s;
+    int    hottest_irq_cpu;         // CPU taking most of the hottest IRQ, -1 if none
+    double irq_imbalance;           // device IRQs: busiest CPU / mean CPU rate (1.0 = even)
+    double net_rx_softirq_per_s;
+    double net_rx_imbalance;        // NET_RX softirq: busiest CPU / mean CPU rate
+} IrqSummary;
+
+/**
+ * Read /proc/interrupts and /proc/softirqs into fixed counter matrices
+ * (reused between calls) and derive per-IRQ per-CPU rates.
+ * @return 0 başarı, -1 hata
+ */
+int interrupts_sample(IrqSummary* out);
+
+/**
+ * Per-IRQ per-CPU rates from the last interrupts_sample(), row major.
+ * Pointers stay valid until the next sample.
+ * @return 0 başarı, -1 no data yet
+ */
+int interrupts_rates(IrqSource src, const double** rates, const char (**names)[IRQ_NAME_MAX],
+                     size_t* rows, size_t* cols);
+
+void interrupts_deinit(void);
+
+/**
+ * --bench-irq: parse a saved /proc/interrupts with every row scanner built
+ * in (scalar, and SSE2/NEON where available), check they produce the same
+ * counter matrix, print us/parse for each.
+ * @return 0, or 1 if the file cannot be parsed or the matrices differ
+ */
+int  interrupts_benchmark(const char* path);
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef COLLECTORS_NET_DEV_H
+#define COLLECTORS_NET_DEV_H
+
+#include <stddef.h>
+
+#define NET_IFNAME_MAX 16
+
+// per-interface rates computed from two consecutive /proc/net/dev reads
+typedef struct NetIfRates {
+    char   name[NET_IFNAME_MAX];
+    double rx_bytes_per_s;
+    double tx_bytes_per_s;
+    double rx_packets_per_s;
+    double tx_packets_per_s;
+    double rx_errs_per_s;
+    double tx_errs_per_s;
+    double rx_drop_per_s;
+    double tx_drop_per_s;
+} NetIfRates;
+
+/**
+ * Read /proc/net/dev and update the per-interface state table.
+ * Interfaces that disappeared since the last call are evicted.
+ * @param top_out      busiest non-loopback interface (rx+tx bytes/s)
+ * @param count_out    number of interfaces currently tracked (may be NULL)
+ * @return 0 başarı, -1 hata
+ */
+int net_dev_sample(NetIfRates* top_out, size_t* count_out);
+
+/**
+ * Rates of every tracked interface, in table order.
+ * @return number of entries written to out (at most max)
+ */
+size_t net_dev_snapshot(NetIfRates* out, size_t max);
+
+void net_dev_deinit(void);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef COLLECTORS_PROC_TOP_H
+#define COLLECTORS_PROC_TOP_H
+
+#include <stddef.h>
+
+#define PROC_TOP_N        5
+#define PROC_COMM_MAX    16
+
+typedef struct ProcTopEntry {
+    int    pid;
+    char   comm[PROC_COMM_MAX];
+    double cpu_percent;     // of one core, like top(1); can exceed 100 for multithreaded
+    long   rss_kb;
+} ProcTopEntry;
+
+/**
+ * Scan /proc/[pid]/stat for every process and select the N busiest by CPU
+ * since the previous scan. The first scan has no baseline and reports 0%.
+ * @param out        at least n entries, sorted busiest first
+ * @param n          how many to select (<= PROC_TOP_N is the common case)
+ * @param total_out  number of processes seen in this scan (may be NULL)
+ * @return number of entries written, -1 hata
+ */
+int proc_top_sample(ProcTopEntry* out, size_t n, size_t* total_out);
+
+void proc_top_deinit(void);
+
+/**
+ * --bench-top N: fork idle children up to N processes in steps and time
+ * full scans at each step, single-threaded and with the worker pool.
+ * @return 0 başarı, 1 hata (fork limit hit before N)
+ */
+int  proc_top_benchmark(unsigned procs);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef COLLECTORS_PSI_H
+#define COLLECTORS_PSI_H
+
+typedef enum {
+    PSI_CPU = 0,
+    PSI_MEMORY,
+    PSI_IO,
+    PSI_COUNT
+} PsiResourceKind;
+
+// one /proc/pressure/<resource> file; avg* are percentages, totals are µs
+typedef struct PsiResource {
+    int    available;       // 0 when the kernel has no PSI (CONFIG_PSI=n or psi=0)
+    double some_avg10, some_avg60, some_avg300;
+    double full_avg10, full_avg60, full_avg300;
+    unsigned long long some_total_us;
+    unsigned long long full_total_us;
+} PsiResource;
+
+/**
+ * Read /proc/pressure/{cpu,memory,io}.
+ * @param out  PSI_COUNT entries indexed by PsiResourceKind
+ * @return 0 if at least one resource was read, -1 hata
+ */
+int psi_read_all(PsiResource out[PSI_COUNT]);
+
+/**
+ * Register "some" stall triggers on every resource: an event fires when
+ * tasks were stalled for threshold_us within any window_us window.
+ * Falls back to the 2 s minimum window that unprivileged users are allowed.
+ * @return number of triggers registered (0 = unsupported)
+ */
+int psi_triggers_init(unsigned threshold_us, unsigned window_us);
+
+/**
+ * Wait up to timeout_ms for a trigger. Sleeps the full timeout when no
+ * triggers are registered, so it can replace the main loop's sleep.
+ * @return 1 stall event, 0 timeout, -1 hata
+ */
+int psi_triggers_wait(int timeout_ms);
+
+void psi_deinit(void);
+
+#endif
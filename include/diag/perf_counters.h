@@ -0,0 +1,35 @@
+#ifndef DIAG_PERF_COUNTERS_H
+#define DIAG_PERF_COUNTERS_H
+
+#include <stdint.h>
+
+// counters for the calling thread, accumulated over every begin/end window
+typedef struct PerfTotals {
+    int      have_cycles;           // hardware counters are often missing in VMs
+    int      have_instructions;
+    int      have_ctx_switches;
+    uint64_t windows;
+    uint64_t cycles;
+    uint64_t instructions;
+    uint64_t ctx_switches;
+    uint64_t last_cycles;           // last window only
+    uint64_t last_instructions;
+    uint64_t last_ctx_switches;
+} PerfTotals;
+
+/**
+ * Open perf_event cycle/instruction counters on the calling thread (user
+ * space only, so it works with the default perf_event_paranoid=2 and no
+ * privileges). Context switches come from getrusage(RUSAGE_THREAD).
+ * @return number of counters available, 0 = none
+ */
+int perf_counters_init(void);
+
+void perf_counters_begin(void);
+void perf_counters_end(void);
+
+void perf_counters_totals(PerfTotals* out);
+
+void perf_counters_deinit(void);
+
+#endif
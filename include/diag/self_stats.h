@@ -0,0 +1,62 @@
+#ifndef DIAG_SELF_STATS_H
+#define DIAG_SELF_STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// what the monitor itself spends time on
+typedef enum {
+    DIAG_SAMPLE = 0,        // whole read_system_stats()
+    DIAG_CPU,
+    DIAG_MEMORY,
+    DIAG_LOADAVG,
+    DIAG_UPTIME,
+    DIAG_TEMP,
+    DIAG_NET,
+    DIAG_PROCS,
+    DIAG_PSI,
+    DIAG_CGROUP,
+    DIAG_IRQ,
+    DIAG_ESTIMATORS,
+    DIAG_RULES,
+    DIAG_PAGE_RENDER,
+    DIAG_LCD_WRITE,
+    DIAG_LOOP,
+    DIAG_STAGE_COUNT
+} DiagStage;
+
+typedef struct DiagSummary {
+    uint64_t count;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    uint64_t max_ns;
+    double   mean_ns;
+} DiagSummary;
+
+uint64_t diag_now_ns(void);
+
+/**
+ * Add one latency sample (log-linear histogram, ~12% bucket width).
+ * A bucket increment and three scalar updates, no locking: call from the
+ * main loop thread only.
+ */
+void diag_record(DiagStage stage, uint64_t ns);
+
+/**
+ * Record now - since for stage and return now, so consecutive stages can
+ * be chained: t = diag_lap(DIAG_CPU, t); ... t = diag_lap(DIAG_MEMORY, t);
+ */
+uint64_t diag_lap(DiagStage stage, uint64_t since);
+
+void diag_summary(DiagStage stage, DiagSummary* out);
+
+const char* diag_stage_name(DiagStage stage);
+
+// text table of every stage plus perf counters
+void diag_dump(FILE* f);
+
+// SIGUSR1 -> diag_dump() on the next diag_poll_dump(), which then returns 1
+void diag_install_sigusr1(void);
+int  diag_poll_dump(FILE* f);
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef FLEET_AGGREGATOR_H
+#define FLEET_AGGREGATOR_H
+
+#include <stdint.h>
+#include "fleet/protocol.h"
+
+/*
+ * Aggregator: one receiver thread drains the UDP socket with recvmmsg()
+ * batches and is the only writer of the node table and the rankings.
+ * Each ranking is an indexed max-heap over the fresh nodes, so a
+ * datagram moves its node in O(log n) and the top K are read off the
+ * heap in O(K log K) without touching the rest. Nodes silent for
+ * FLEET_STALE_MS leave the rankings until they speak again.
+ *
+ * Readers (LCD, terminal) get a FleetView published under a seqlock:
+ * the receiver never waits for them.
+ */
+
+#define FLEET_MAX_NODES  1024
+#define FLEET_TOP_K      5
+#define FLEET_STALE_MS   5000
+
+typedef enum {
+    FLEET_RANK_TEMP = 0,        // hottest
+    FLEET_RANK_CORE,            // busiest single core
+    FLEET_RANK_CPU,             // busiest overall
+    FLEET_RANK_MEM,             // least memory left (highest used %)
+    FLEET_RANK_COUNT
+} FleetRank;
+
+typedef struct FleetEntry {
+    char     node[FLEET_NODE_MAX];
+    float    value;             // the ranked metric
+    uint16_t core;              // FLEET_RANK_CORE: which core
+    uint32_t age_ms;
+} FleetEntry;
+
+typedef struct FleetView {
+    uint64_t   published_ns;
+    unsigned   nodes;           // ever seen (up to FLEET_MAX_NODES)
+    unsigned   stale;
+    uint64_t   received;        // valid datagrams
+    uint64_t   lost;            // sequence gaps
+    uint64_t   bad;             // not decodable, or table full
+    double     datagrams_per_s;
+    double     batch_mean;      // datagrams per recvmmsg() call
+    unsigned   top_count[FLEET_RANK_COUNT];
+    FleetEntry top[FLEET_RANK_COUNT][FLEET_TOP_K];
+} FleetView;
+
+/**
+ * Bind UDP port (0 = any free one, see fleet_aggregator_port()) on all
+ * addresses and start the receiver thread.
+ * @return 0 başarı, -1 hata
+ */
+int  fleet_aggregator_start(uint16_t port);
+
+int  fleet_aggregator_running(void);
+
+uint16_t fleet_aggregator_port(void);
+
+/**
+ * Copy the latest published view (refreshed every 100 ms).
+ * @return 0 başarı, -1 not running / nothing published yet
+ */
+int  fleet_aggregator_view(FleetView* out);
+
+void fleet_aggregator_stop(void);
+
+#endif
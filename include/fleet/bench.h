@@ -0,0 +1,12 @@
+#ifndef FLEET_BENCH_H
+#define FLEET_BENCH_H
+
+/**
+ * --fleet-bench: a loopback aggregator fed flat out by nodes simulated
+ * senders (fleet_simulate_start). Prints datagrams/s sent, received and
+ * dropped, and the mean recvmmsg() batch.
+ * @return process exit code
+ */
+int fleet_benchmark(unsigned nodes);
+
+#endif
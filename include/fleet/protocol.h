@@ -0,0 +1,49 @@
+#ifndef FLEET_PROTOCOL_H
+#define FLEET_PROTOCOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "hardware_stats.h"
+
+/*
+ * One node's sample as a single UDP datagram:
+ *
+ *   "HWF" u8 version, varint name length, name, varint seq,
+ *   then the metrics below as zigzag varints in fixed point
+ *
+ * Fixed point keeps a typical datagram around 40 bytes; the varint and
+ * zigzag helpers are the ones of the binary stream (stream/format.h).
+ */
+
+#define FLEET_MAGIC         "HWF"
+#define FLEET_MAGIC_LEN     3
+#define FLEET_VERSION       1
+#define FLEET_NODE_MAX      32
+#define FLEET_DATAGRAM_MAX  128
+#define FLEET_DEFAULT_PORT  9871
+
+typedef struct FleetSample {
+    char     node[FLEET_NODE_MAX];  // hostname, NUL terminated
+    uint32_t seq;                   // per sender, to count lost datagrams
+    float    cpu_percent;
+    float    busiest_core_percent;
+    uint16_t busiest_core;
+    float    temp_c;                // <= 0 if unknown
+    float    mem_used_percent;
+    uint64_t mem_available_kb;
+    float    load1;
+    float    psi_memory_some10;
+} FleetSample;
+
+// node name and seq are left to the caller
+void   fleet_sample_from_stats(FleetSample* out, const HardwareStats* s);
+
+// @return datagram length (<= FLEET_DATAGRAM_MAX)
+size_t fleet_encode(const FleetSample* s, uint8_t* buf);
+
+/**
+ * @return 0 başarı, -1 hata (not a fleet datagram, other version, truncated)
+ */
+int    fleet_decode(const uint8_t* buf, size_t len, FleetSample* out);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef FLEET_SENDER_H
+#define FLEET_SENDER_H
+
+#include <stdint.h>
+#include "hardware_stats.h"
+
+// one datagram per node per second
+#define FLEET_SEND_PERIOD_MS 1000
+
+/**
+ * Send this node's samples to an aggregator at "host:port" (port
+ * defaults to FLEET_DEFAULT_PORT). The node name is the hostname.
+ * @return 0 başarı, -1 hata (bad address)
+ */
+int  fleet_sender_open(const char* target);
+
+int  fleet_sender_is_open(void);
+
+// sends at most once per FLEET_SEND_PERIOD_MS; never blocks
+void fleet_sender_tick(const HardwareStats* s, uint64_t now_ns);
+
+void fleet_sender_close(void);
+
+/**
+ * Loopback load generator: nodes simulated nodes ("sim0000" ...) with
+ * random-walk metrics, spread over a few threads sending with
+ * sendmmsg() to 127.0.0.1:port. hz is the per-node rate, 0 = flat out.
+ * @return 0 başarı, -1 hata
+ */
+int  fleet_simulate_start(uint16_t port, unsigned nodes, unsigned hz);
+
+// datagrams handed to the kernel by the simulators so far
+uint64_t fleet_simulate_sent(void);
+
+void fleet_simulate_stop(void);
+
+#endif
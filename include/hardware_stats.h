@@ -1,23 +1,99 @@
 #ifndef HARDWARE_STATS_H
 #define HARDWARE_STATS_H
 
+#include <stdint.h>
+
+#include "collectors/proc_top.h"
+#include "collectors/psi.h"
+#include "collectors/cgroup.h"
+#include "collectors/interrupts.h"
+
 
 // struct data to hold system stats. 
 // read_system_stats(SystemStats* out) function reads system stats with the help of the functions , which have static linkage, defined inside hardware_stats.c
 
 
+#define HW_MAX_CORES 256
+
 typedef struct HardwareStats {
 
     double cpu_usage_percent;   // the last calculated cpu usage percentage %
+    unsigned core_count;        // highest online cpuN + 1
+    double core_usage_percent[HW_MAX_CORES];
     long mem_total_kb;
     long mem_available_kb;
+    double mem_used_percent;    // (total - available) / total
+
+    // rest of /proc/meminfo (kB)
+    long mem_free_kb, mem_buffers_kb, mem_cached_kb;
+    long mem_active_kb, mem_inactive_kb;
+    long mem_dirty_kb, mem_writeback_kb;
+    long mem_anon_kb, mem_mapped_kb, mem_shmem_kb;
+    long mem_slab_kb, mem_sreclaimable_kb, mem_sunreclaim_kb;
+    long mem_kernel_stack_kb, mem_page_tables_kb;
+    long mem_committed_kb, mem_commit_limit_kb;
+    long swap_total_kb, swap_free_kb, swap_cached_kb;
+
+    // /proc/vmstat counters as rates per second
+    double pgfault_per_s, pgmajfault_per_s;
+    double pswpin_per_s, pswpout_per_s;
+    double pgpgin_per_s, pgpgout_per_s;
+    double pgsteal_per_s, allocstall_per_s;
+    unsigned long long oom_kill_total;
     double load1, load5, load15;
     double uptime_seconds;
     double cpu_temp_c;
 
+    // busiest non-loopback interface from /proc/net/dev (rates per second)
+    char   net_iface[16];
+    unsigned net_iface_count;
+    double net_rx_bytes_per_s, net_tx_bytes_per_s;
+    double net_rx_packets_per_s, net_tx_packets_per_s;
+    double net_rx_errs_per_s, net_tx_errs_per_s;
+    double net_rx_drop_per_s, net_tx_drop_per_s;
+
+    // busiest processes since the previous read, busiest first
+    ProcTopEntry top_procs[PROC_TOP_N];
+    unsigned top_proc_count;
+    unsigned proc_count;
+
+    // pressure stall information, indexed by PsiResourceKind
+    PsiResource psi[PSI_COUNT];
+
+    // cgroup v2 with the highest CPU usage
+    CgroupStats cgroup_top;
+    unsigned cgroup_count;
+
+    // /proc/interrupts + /proc/softirqs rates and per-CPU spread
+    IrqSummary irq;
+
 }HardwareStats;
 
 
 int read_system_stats(HardwareStats* out);
 
+/**
+ * Adaptive alternative to read_system_stats(): runs only the collectors
+ * whose scheduler deadline has come (see sched/scheduler.h), updating
+ * their part of out. Fields of collectors that did not run keep their
+ * last values, so keep passing the same struct.
+ * @return number of collectors run, -1 hata (a required source failed)
+ */
+int read_due_stats(HardwareStats* out, uint64_t now_ns);
+
+// CLOCK_MONOTONIC ns of the next read_due_stats() work
+uint64_t read_due_stats_deadline(void);
+
+/**
+ * Keep recent history in the ring file at path (see history/ring.h) and
+ * warm start from it: samples of the last five minutes are replayed into
+ * the estimators and, within the same boot, the previous cumulative CPU
+ * counters are adopted so the first CPU reading is a real one. Call
+ * before the first read_*_stats().
+ * @return number of samples recovered, -1 hata
+ */
+int  stats_history_open(const char* path);
+
+void stats_history_close(void);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,55 @@
+#ifndef HISTORY_RING_H
+#define HISTORY_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Recent history in an mmap()ed file, kept across restarts.
+ *
+ *   header   64 bytes: magic, geometry, writer generation, boot id, checksum
+ *   slots    HISTORY_SLOTS x 64 bytes, slot = seq % HISTORY_SLOTS
+ *
+ * A sample is composed on the stack and copied into its cache-line-sized
+ * slot; nothing is synced, the kernel writes dirty pages back on its own.
+ * A slot torn by a crash or power loss fails its checksum and is dropped
+ * on recovery, together with everything older than it.
+ */
+
+#define HISTORY_SLOT_SIZE   64
+#define HISTORY_SLOTS       600     // 10 min at one sample per second
+#define HISTORY_VALUES      8
+
+typedef struct HistorySample {
+    uint32_t seq;                   // 1, 2, ...; 0 = never written
+    uint32_t checksum;              // over the slot with this field zeroed
+    uint64_t unix_ms;
+    uint64_t cpu_total, cpu_idle;   // cumulative /proc/stat jiffies, all cores
+    float    values[HISTORY_VALUES];
+} HistorySample;
+
+/**
+ * Map (creating or resetting it if needed) the ring at path and recover
+ * the valid samples in it. Fails if another process holds the file.
+ * @return 0 başarı, -1 hata
+ */
+int  history_open(const char* path);
+
+int  history_is_open(void);
+
+// 1 if the recovered samples were written since the current boot
+int  history_same_boot(void);
+
+/**
+ * Recovered samples newer than max_age_ms, oldest first. Call before the
+ * first history_append(), which starts overwriting the oldest of them.
+ * @return number copied
+ */
+size_t history_recovered(HistorySample* out, size_t max, uint64_t max_age_ms);
+
+// stamps seq and checksum, then stores the slot
+void history_append(HistorySample* s);
+
+void history_close(void);
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef LCD_DISPLAY_H
+#define LCD_DISPLAY_H
+
+#include <stdint.h>
+#include "page.h"
+#include "lcd/hd44780.h"
+
+/*
+ * All LCD panels of the process behind one frame. Pages are rendered
+ * once per snapshot into LCD_COLS x 2 tiles; a panel shows as many tiles
+ * as its geometry holds (16x2: one, 20x4: two stacked, 40x2: two side by
+ * side), tile 0 being the current page.
+ *
+ * Each panel keeps a shadow of what is on its glass and the target from
+ * the last frame; its transfer queue is the difference between the two,
+ * so a frame that arrives before the previous one is out replaces it
+ * instead of queueing behind it. display_pump() hands the shared bus to
+ * the panels in turn, one byte each, and skips a panel still executing
+ * its last byte: a slow panel (or one busy clearing) costs the others
+ * nothing.
+ */
+
+#define DISPLAY_MAX_PANELS  HD44780_MAX_PANELS
+#define DISPLAY_MAX_CELLS   80          // DDRAM of one controller
+#define DISPLAY_MAX_TILES   4
+
+typedef struct DisplayPanelConfig {
+    unsigned cols, rows;
+    unsigned e_pin;
+    unsigned exec_us;                   // per byte, 0 = HD44780_EXEC_NS
+} DisplayPanelConfig;
+
+typedef struct Display Display;
+
+/**
+ * Parse "COLSxROWS[@E_PIN][/EXEC_US]", e.g. "20x4@16" or "40x2@12/80".
+ * E_PIN defaults to PIN_LCD_E. Accepted: 2 or 4 rows, LCD_COLS..40
+ * columns, at most DISPLAY_MAX_CELLS cells.
+ * @return 0 başarı, -1 hata
+ */
+int  display_parse_panel(const char* spec, DisplayPanelConfig* out);
+
+/**
+ * Initialise the panels (at most DISPLAY_MAX_PANELS, distinct E pins).
+ * @return 0 başarı, -1 hata
+ */
+int  display_open(Display** out, const DisplayPanelConfig* panels, unsigned n);
+void display_close(Display* d);
+
+// tiles the largest panel shows: how many pages to render per frame
+unsigned display_tiles(const Display* d);
+
+// the next frame; tiles past ntiles are blank
+void display_set_frame(Display* d, const PageTile* tiles, unsigned ntiles);
+
+// blank every panel (flushed by the next pump)
+void display_blank(Display* d);
+
+/**
+ * Move bytes to the panels until all of them show the frame or
+ * deadline_ns (CLOCK_MONOTONIC) passes; what is left goes next time.
+ * @return 1 all in sync, 0 still pending, -1 hata
+ */
+int  display_pump(Display* d, uint64_t deadline_ns);
+
+#endif
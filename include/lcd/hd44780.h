@@ -1,16 +1,39 @@
 #ifndef HD44780_H
 #define HD44780_H
 
+#include <stdint.h>
+
+/*
+ * HD44780 panels in 4-bit mode on one shared bus: RS and D4..D7 go to
+ * every panel, each panel has its own E line (config/pins.h has the
+ * first one). Only the panel whose E is pulsed latches the byte, so
+ * while one panel executes a command the bus is free for the others.
+ */
+
+#define HD44780_MAX_PANELS  4
+#define HD44780_EXEC_NS     40000       // most commands and data writes (37 us + margin)
+#define HD44780_CLEAR_NS    1600000     // clear display / return home
+
+#define HD44780_CMD_CLEAR   0x01
+#define HD44780_CMD_DDRAM   0x80        // | address
+
 typedef struct Hd44780 Hd44780;
 
-int  hd44780_init(Hd44780** out);
+/**
+ * Request the bus lines plus one E line per panel and initialise all
+ * panels together (4-bit, two-line mode, cleared, cursor off). exec_ns
+ * is the slowest panel's per-byte time, 0 = HD44780_EXEC_NS.
+ * @return 0 başarı, -1 hata
+ */
+int  hd44780_init(Hd44780** out, const unsigned* e_pins, unsigned panels, uint64_t exec_ns);
 void hd44780_deinit(Hd44780* lcd);
 
-int  hd44780_clear(Hd44780* lcd);
-int  hd44780_set_cursor(Hd44780* lcd, int row, int col);
-int  hd44780_write_str(Hd44780* lcd, const char* s);
-
-// 16x2 tek çağrı (flicker azaltır)
-int  hd44780_write_lines(Hd44780* lcd, const char line1[17], const char line2[17]);
+/**
+ * Clock one byte (rs 0 = command, 1 = data) into one panel. Returns as
+ * soon as it is latched: the panel then stays busy for HD44780_EXEC_NS
+ * (HD44780_CLEAR_NS after a clear) and must not be sent to before that.
+ * @return 0 başarı, -1 hata
+ */
+int  hd44780_send(Hd44780* lcd, unsigned panel, int rs, uint8_t byte);
 
-#endif
\ No newline at end of file
+#endif
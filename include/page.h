@@ -9,6 +9,14 @@
 typedef struct Page Page;
 
 
+// one page's output; bigger panels show several side by side or stacked
+typedef struct PageTile {
+
+    char line[2][LCD_COLS + 1];
+
+}PageTile;
+
+
 typedef void(*page_render_fn)(const Page* page, const HardwareStats* stats, char line1[LCD_COLS + 1], char line2[LCD_COLS + 1]);
 
 
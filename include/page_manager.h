@@ -4,6 +4,7 @@
 #include <stddef.h>
 #include "page.h"
 #include "hardware_stats.h"
+#include "alerts/rules.h"
 
 #ifdef _cplusplus
 extern "C" {
@@ -14,6 +15,7 @@ typedef struct {
     Page* head;
     Page* current;
     size_t count;
+    Page** pages;       // count entries, in display order
 
 }PageManager;
 
@@ -22,14 +24,32 @@ int page_manager_init(PageManager* pm);
 
 void page_manager_deinit(PageManager* pm);
 
+/**
+ * Add the pages of a pages file (see config/pages.conf and
+ * pages/template.h) after the built-in ones; a page named like an
+ * existing one replaces it. Bad pages are reported on stderr and skipped.
+ * @return number of pages loaded, -1 hata (file unreadable)
+ */
+int page_manager_load(PageManager* pm, const char* path);
+
 void page_manager_next(PageManager* pm);
 
 void page_manager_prev(PageManager* pm);
 
 void page_manager_render(const PageManager* pm, const HardwareStats* stats, char line1[LCD_COLS + 1], char line2[LCD_COLS + 1]);
 
+/**
+ * Render the current page and the ones after it into tiles[0..n-1], for
+ * panels that show more than one page at once.
+ * @return number of tiles rendered (never more than the page count)
+ */
+size_t page_manager_render_tiles(const PageManager* pm, const HardwareStats* stats, PageTile* tiles, size_t n);
+
 const char* page_manager_current_name(const PageManager* pm);
 
+// full-screen alert that takes over the LCD while a rule fires; phase toggles the blink
+void page_manager_render_alert(const RuleAlert* alert, int phase, char line1[LCD_COLS + 1], char line2[LCD_COLS + 1]);
+
 #ifdef _cplusplus
 }
 #endif
@@ -0,0 +1,12 @@
+#ifndef PAGES_BENCH_H
+#define PAGES_BENCH_H
+
+/**
+ * --bench-pages: the built-in CPU page (snprintf) against the same two
+ * lines as a template. Checks both print the same digits for a spread of
+ * inputs, then prints ns/render for each, best of a few rounds.
+ * @return 0, or 1 if any output differs
+ */
+int page_benchmark(void);
+
+#endif
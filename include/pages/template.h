@@ -0,0 +1,60 @@
+#ifndef PAGES_TEMPLATE_H
+#define PAGES_TEMPLATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "hardware_stats.h"
+
+/*
+ * One display line as a template over stat_fields() metrics:
+ *
+ *   CPU:{cpu:5.1}% {temp:2.0}C
+ *   RAM {mem.available/1024:5.0}M
+ *   R:{net.rx_bytes:b} T:{net.tx_bytes:b}
+ *
+ *   {field[*k|/k][:[-|0][width][.precision][b]]}    "{{" is a literal '{'
+ *
+ * width and precision mean what they mean to printf's %f; "-" left-aligns,
+ * "0" zero-pads, "b" prints a byte count as "9.9K", " 123M". Unscaled
+ * integer fields default to precision 0, everything else to 1.
+ *
+ * Compiling resolves every field to its offset and type once; rendering
+ * walks the op array and formats numbers itself, no lookups and no snprintf
+ * except for the rare value that sits on a rounding tie.
+ */
+
+#define TEMPLATE_MAX_OPS     16
+#define TEMPLATE_LITERAL_MAX 64
+
+typedef enum {
+    TEMPLATE_LITERAL = 0,
+    TEMPLATE_NUMBER,
+    TEMPLATE_BYTES
+} TemplateOpKind;
+
+typedef struct TemplateOp {
+    double   scale;             // multiplier applied before formatting
+    uint32_t offset;            // HardwareStats offset, or literal pool start
+    uint8_t  kind;              // TemplateOpKind
+    uint8_t  type;              // StatFieldType of the field
+    uint8_t  width, precision;
+    uint8_t  left, zero;        // '-' and '0' flags
+    uint8_t  len;               // literal length
+} TemplateOp;
+
+typedef struct PageTemplate {
+    TemplateOp op[TEMPLATE_MAX_OPS];
+    uint8_t    op_count;
+    char       literals[TEMPLATE_LITERAL_MAX];
+} PageTemplate;
+
+/**
+ * Compile one line. On failure *err points to a static message.
+ * @return 0 başarı, -1 hata
+ */
+int  page_template_compile(PageTemplate* t, const char* src, const char** err);
+
+// exactly cols characters (space padded / truncated) plus the terminator
+void page_template_render(const PageTemplate* t, const HardwareStats* s, char* out, size_t cols);
+
+#endif
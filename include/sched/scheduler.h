@@ -0,0 +1,56 @@
+#ifndef SCHED_SCHEDULER_H
+#define SCHED_SCHEDULER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SCHEDULER_MAX_SOURCES 16
+
+typedef struct SchedulerConfig {
+    const char* name;
+    uint32_t min_ms;        // fastest cadence, used while the signal moves
+    uint32_t max_ms;        // slowest cadence, reached by doubling while it is flat
+    double   threshold;     // relative change per run that counts as volatile
+    double   floor;         // |signal| below this is treated as this (avoids 0 -> 1 = infinite change)
+    double   budget;        // max fraction of one CPU the source may use, 0 = unlimited
+} SchedulerConfig;
+
+typedef struct SchedulerStatus {
+    const char* name;
+    uint32_t interval_ms;
+    double   volatility;    // smoothed relative change
+    double   cost_us;       // smoothed run time
+    uint64_t runs;
+} SchedulerStatus;
+
+/**
+ * Register a source, first due immediately.
+ * @return source id, -1 hata (table full)
+ */
+int scheduler_add(const SchedulerConfig* cfg, uint64_t now_ns);
+
+// earliest deadline over every source, UINT64_MAX if none
+uint64_t scheduler_next_deadline(void);
+
+/**
+ * Pop every source due by now_ns (+ a small coalescing slack), so one
+ * wakeup serves all of them. Each popped id must be handed back through
+ * scheduler_report().
+ * @return number of ids written
+ */
+size_t scheduler_pop_due(uint64_t now_ns, int* ids, size_t max);
+
+/**
+ * Feed the run's result back: signal is the source's headline value,
+ * cost_ns what the run took. Picks the next interval and re-arms it.
+ */
+void scheduler_report(int id, uint64_t now_ns, double signal, uint64_t cost_ns);
+
+// every source to min_ms and due now (e.g. on a PSI stall event)
+void scheduler_boost(uint64_t now_ns);
+
+size_t scheduler_status(SchedulerStatus* out, size_t max);
+
+void scheduler_reset(void);
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef STATS_ESTIMATORS_H
+#define STATS_ESTIMATORS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "hardware_stats.h"
+
+/*
+ * DDSketch with fixed log-spaced bins: every quantile it reports is
+ * within DDS_RELATIVE_ACCURACY of a real sample. Bin 0 holds values below
+ * DDS_MIN_VALUE (zero, and negatives, which no HardwareStats field has);
+ * values above the top bin collapse into it.
+ */
+#define DDS_RELATIVE_ACCURACY 0.02
+#define DDS_MIN_VALUE         1e-3
+#define DDS_BINS              880       // 1e-3 .. ~1e12 at 2%
+
+typedef struct DDSketch {
+    uint32_t count;
+    uint16_t bins[DDS_BINS];    // sliding windows hold at most EST_RING_SLOTS samples
+} DDSketch;
+
+int    ddsketch_bin(double v);
+void   ddsketch_clear(DDSketch* d);
+void   ddsketch_add_bin(DDSketch* d, int bin);
+void   ddsketch_remove_bin(DDSketch* d, int bin);
+
+// bin-wise sum, saturating; sketches of the same metric from different windows or hosts
+void   ddsketch_merge(DDSketch* dst, const DDSketch* src);
+
+/**
+ * Several quantiles in one pass over the bins.
+ * @param qs   ascending, each in [0, 1]
+ * @param out  n values, 0 when the sketch is empty
+ */
+void   ddsketch_quantiles(const DDSketch* d, const double* qs, double* out, size_t n);
+
+/* ---------- per-field estimators ---------- */
+
+typedef enum {
+    EST_EWMA_10S = 0,
+    EST_EWMA_1M,
+    EST_EWMA_5M,
+    EST_EWMA_COUNT
+} EstEwma;
+
+typedef enum {
+    EST_WINDOW_1M = 0,
+    EST_WINDOW_5M,
+    EST_WINDOW_COUNT
+} EstWindow;
+
+// samples kept for the sliding windows: 10 min at the 1 Hz hardware_stats.c feeds them
+#define EST_RING_SLOTS 600
+
+/**
+ * Feed one sample of every stat_fields() entry. Called at 1 Hz from the stats
+ * read paths; the ring only spans the 5 min window up to 2 Hz.
+ * no allocation, O(fields) per call plus O(fields) per sample that ages out.
+ */
+void estimators_update(const HardwareStats* s, uint64_t now_ns);
+
+/**
+ * Same, for the fields with present[index] set only; the others keep
+ * their state. Used to replay recovered history, oldest first and before
+ * any live sample.
+ */
+void estimators_update_partial(const HardwareStats* s, const unsigned char* present, uint64_t now_ns);
+
+// field indexes are stat_field_index() positions; out-of-range fields read 0
+double estimators_ewma(int field, EstEwma which);
+
+// p50, p95, p99 over the window
+typedef struct EstQuantiles {
+    uint32_t count;
+    double   p50, p95, p99;
+} EstQuantiles;
+
+void estimators_quantiles(int field, EstWindow window, EstQuantiles* out);
+
+// underlying window sketch, for exporters that merge across hosts
+const DDSketch* estimators_sketch(int field, EstWindow window);
+
+void estimators_reset(void);
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef STATS_FIELDS_H
+#define STATS_FIELDS_H
+
+#include <stddef.h>
+#include "hardware_stats.h"
+
+// storage type of a numeric HardwareStats member
+typedef enum {
+    STAT_DOUBLE = 0,
+    STAT_LONG,
+    STAT_UINT,
+    STAT_ULL
+} StatFieldType;
+
+// upper bound on stat_fields() entries, for per-field static arrays
+#define STAT_FIELD_MAX 96
+
+typedef struct StatField {
+    const char*   name;     // dotted, e.g. "psi.memory.some10"
+    size_t        offset;   // offsetof(HardwareStats, ...)
+    StatFieldType type;
+} StatField;
+
+/**
+ * Every scalar metric in HardwareStats, in a fixed order that other
+ * modules index by (stat_field_index()).
+ */
+const StatField* stat_fields(size_t* count);
+
+// NULL / -1 if the name is unknown
+const StatField* stat_field_find(const char* name);
+int stat_field_index(const char* name);
+
+static inline double stat_field_value(const StatField* f, const HardwareStats* s) {
+    const char* p = (const char*)s + f->offset;
+    switch (f->type) {
+        case STAT_DOUBLE: return *(const double*)p;
+        case STAT_LONG:   return (double)*(const long*)p;
+        case STAT_UINT:   return (double)*(const unsigned*)p;
+        case STAT_ULL:    return (double)*(const unsigned long long*)p;
+    }
+    return 0.0;
+}
+
+#endif
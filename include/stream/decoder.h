@@ -0,0 +1,32 @@
+#ifndef STREAM_DECODER_H
+#define STREAM_DECODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "stream/format.h"
+
+typedef struct StreamDecoder StreamDecoder;
+
+typedef struct StreamCallbacks {
+    // a (possibly changed) dictionary; fields stay valid until the next call
+    void (*on_fields)(void* ctx, const StreamField* fields, size_t n);
+    // values are already divided back by 10^decimals
+    void (*on_sample)(void* ctx, uint64_t unix_ms, const double* values, size_t n);
+} StreamCallbacks;
+
+StreamDecoder* stream_decoder_new(void);
+
+/**
+ * Feed any amount of stream bytes; complete records are decoded and
+ * handed to the callbacks, the rest is kept for the next call. Garbage and
+ * samples before the first keyframe are skipped up to the next sync header.
+ * @return 0 başarı, -1 hata (out of memory)
+ */
+int  stream_decoder_feed(StreamDecoder* d, const uint8_t* data, size_t len, const StreamCallbacks* cb, void* ctx);
+
+// bytes skipped while resynchronising
+uint64_t stream_decoder_skipped(const StreamDecoder* d);
+
+void stream_decoder_free(StreamDecoder* d);
+
+#endif
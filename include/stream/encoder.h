@@ -0,0 +1,44 @@
+#ifndef STREAM_ENCODER_H
+#define STREAM_ENCODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "stream/format.h"
+
+// samples between keyframes (a keyframe resends sync + dictionary)
+#define STREAM_KEYFRAME_EVERY 60
+
+typedef struct StreamWriter StreamWriter;
+
+/**
+ * Open an output: "-" is stdout, anything else a file (appended) or FIFO
+ * (blocks until a reader opens it).
+ * @return NULL hata
+ */
+StreamWriter* stream_writer_open(const char* path);
+
+// same, over an already open fd (not closed by stream_writer_close)
+StreamWriter* stream_writer_fdopen(int fd);
+
+/**
+ * Set the field dictionary; the next sample is written as a keyframe.
+ * @return 0 başarı, -1 hata
+ */
+int  stream_writer_set_fields(StreamWriter* w, const StreamField* fields, size_t n);
+
+/**
+ * Encode one sample (values already scaled by each field's decimals).
+ * Records are batched and written with writev() once enough is buffered
+ * or the oldest buffered record is a second old.
+ * @return 0 başarı, -1 hata (reader gone, disk full ...)
+ */
+int  stream_writer_sample(StreamWriter* w, uint64_t unix_ms, const int64_t* values);
+
+int  stream_writer_flush(StreamWriter* w);
+
+// bytes handed to the kernel so far
+uint64_t stream_writer_bytes(const StreamWriter* w);
+
+void stream_writer_close(StreamWriter* w);
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef STREAM_FORMAT_H
+#define STREAM_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Binary sample stream, version 1.
+ *
+ *   sync     "HWMS" u8 version u8 flags          at start and before every dictionary
+ *   record   u8 type, varint payload length, payload
+ *
+ *   'D' dictionary  varint n, n x (varint name length, name, u8 decimals)
+ *   'K' keyframe    varint unix time ms, n x zigzag varint value
+ *   'S' sample      zigzag varint time delta ms, n x zigzag varint delta to the previous record
+ *
+ * Values are integers: a field with d decimals carries round(value * 10^d).
+ * Every keyframe is preceded by a sync header and the dictionary, so a
+ * reader can start (or recover) at any "HWMS". Unknown record types are
+ * skipped by length.
+ */
+
+#define STREAM_MAGIC        "HWMS"
+#define STREAM_MAGIC_LEN    4
+#define STREAM_VERSION      1
+#define STREAM_SYNC_LEN     (STREAM_MAGIC_LEN + 2)
+
+#define STREAM_REC_DICTIONARY 'D'
+#define STREAM_REC_KEYFRAME   'K'
+#define STREAM_REC_SAMPLE     'S'
+
+#define STREAM_NAME_MAX     48
+#define STREAM_MAX_FIELDS   256
+#define STREAM_VARINT_MAX   10
+
+typedef struct StreamField {
+    char    name[STREAM_NAME_MAX];
+    uint8_t decimals;
+} StreamField;
+
+static inline uint64_t stream_zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t stream_unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+// LEB128; returns bytes written (<= STREAM_VARINT_MAX)
+static inline size_t stream_put_varint(uint8_t* p, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+// returns bytes consumed, 0 if truncated or longer than 10 bytes
+static inline size_t stream_get_varint(const uint8_t* p, size_t len, uint64_t* out) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < len && i < STREAM_VARINT_MAX; i++) {
+        v |= (uint64_t)(p[i] & 0x7f) << (7 * i);
+        if (!(p[i] & 0x80)) {
+            *out = v;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef STREAM_STREAM_RUN_H
+#define STREAM_STREAM_RUN_H
+
+#include "hardware_stats.h"
+
+/**
+ * --stream: run the collectors and write one binary record per collector
+ * wakeup to path ("-" = stdout, file or FIFO), see stream/format.h.
+ * Runs until SIGINT/SIGTERM or the reader goes away.
+ * @return process exit code
+ */
+int stream_stats(HardwareStats* s, const char* path);
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef TERMINAL_SCREEN_H
+#define TERMINAL_SCREEN_H
+
+typedef struct Screen Screen;
+
+/**
+ * Full-screen ANSI output on fd (alternate screen, hidden cursor).
+ * Frames are composed into a cell buffer and only the cells that changed
+ * since the previous frame are written, in one write() per frame.
+ * @return 0 başarı, -1 hata
+ */
+int  screen_init(Screen** out, int fd);
+
+// restores the normal screen and cursor
+void screen_deinit(Screen* scr);
+
+/**
+ * Start a new frame: picks up terminal resizes and blanks the back buffer.
+ */
+void screen_begin_frame(Screen* scr);
+
+int  screen_rows(const Screen* scr);
+int  screen_cols(const Screen* scr);
+
+// text is clipped at the right edge; newlines are not interpreted
+void screen_put(Screen* scr, int row, int col, const char* text);
+
+#if defined(__GNUC__)
+__attribute__((format(printf, 4, 5)))
+#endif
+void screen_printf(Screen* scr, int row, int col, const char* fmt, ...);
+
+// "[#####.....]" of the given total width (brackets included)
+void screen_bar(Screen* scr, int row, int col, int width, double percent);
+
+// next flush repaints everything (something else wrote to the terminal)
+void screen_invalidate(Screen* scr);
+
+/**
+ * Emit the diff against the previous frame.
+ * @return bytes written, -1 hata
+ */
+int  screen_flush(Screen* scr);
+
+#endif
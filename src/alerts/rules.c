@@ -0,0 +1,537 @@
+#define _GNU_SOURCE
+#include "alerts/rules.h"
+#include "stats/fields.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/* =======================
+ * Internal structures
+ * ======================= */
+
+typedef enum { OP_GT = 0, OP_GE, OP_LT, OP_LE, OP_EQ, OP_NE } RuleOpKind;
+typedef enum { RULE_IDLE = 0, RULE_PENDING, RULE_FIRING } RuleState;
+typedef enum { HOOK_NONE = 0, HOOK_EXEC, HOOK_FIFO } HookKind;
+
+static const char* const g_op_text[] = { ">", ">=", "<", "<=", "==", "!=" };
+
+// one comparison; a rule's terms are consecutive in g_ops
+typedef struct {
+    uint16_t field;
+    uint8_t  op;
+    double   raise;     // threshold while idle
+    double   clear;     // threshold while firing
+} RuleOp;
+
+typedef struct {
+    char     name[RULE_NAME_MAX];
+    uint32_t first_op;
+    uint32_t op_count;
+
+    uint64_t for_ns, hold_ns, cooldown_ns;
+    HookKind hook_kind;
+    char*    hook;
+
+    RuleState state;
+    uint64_t  pending_since_ns;
+    uint64_t  firing_since_ns;
+    uint64_t  last_hook_ns;
+    int       hooked;       // a hook ran at least once
+    int       notified;     // the current firing was announced, so announce the clear too
+    int       acked;
+} Rule;
+
+static RuleOp*  g_ops = NULL;
+static size_t   g_op_count = 0;
+static Rule*    g_rules = NULL;
+static size_t   g_rule_count = 0;
+
+// field -> rules reading it (CSR), and the fields any rule reads
+static uint32_t g_field_first[STAT_FIELD_MAX + 1];
+static uint32_t* g_field_rules = NULL;
+static uint16_t g_used_fields[STAT_FIELD_MAX];
+static size_t   g_used_count = 0;
+
+static double   g_values[STAT_FIELD_MAX];
+static int      g_values_valid = 0;
+
+static uint64_t* g_dirty = NULL;    // one bit per rule
+static size_t    g_dirty_words = 0;
+
+// exec hooks still running; only these are reaped, other children of the process are left alone
+static pid_t*   g_hook_pids = NULL;
+static size_t   g_hook_count = 0;
+static size_t   g_hook_cap = 0;
+
+/* =======================
+ * Helpers
+ * ======================= */
+
+static int compare(uint8_t op, double v, double t) {
+    switch (op) {
+        case OP_GT: return v >  t;
+        case OP_GE: return v >= t;
+        case OP_LT: return v <  t;
+        case OP_LE: return v <= t;
+        case OP_EQ: return v == t;
+        case OP_NE: return v != t;
+    }
+    return 0;
+}
+
+static int parse_op(const char* s) {
+    for (int i = 0; i < (int)(sizeof(g_op_text) / sizeof(g_op_text[0])); i++) {
+        if (strcmp(s, g_op_text[i]) == 0) return i;
+    }
+    return -1;
+}
+
+static int parse_duration_ns(const char* s, uint64_t* out) {
+    char* end;
+    double v = strtod(s, &end);
+    if (end == s || v < 0.0) return -1;
+
+    double mul = 1.0;
+    if (*end == 's') end++;
+    else if (*end == 'm') { mul = 60.0; end++; }
+    else if (*end == 'h') { mul = 3600.0; end++; }
+    if (*end != '\0') return -1;
+
+    *out = (uint64_t)(v * mul * 1e9);
+    return 0;
+}
+
+static char* trim(char* s) {
+    while (isspace((unsigned char)*s)) s++;
+    char* e = s + strlen(s);
+    while (e > s && isspace((unsigned char)e[-1])) *--e = '\0';
+    return s;
+}
+
+/*
+ * '#' starts a comment at the start of the line or after whitespace. The
+ * hook argument after "->" runs to the end of the line: a command or path
+ * may contain '#' (sh drops its own comments).
+ */
+static void strip_comment(char* s) {
+    for (char* p = s; *p; p++) {
+        if (p[0] == '-' && p[1] == '>') return;
+        if (*p == '#' && (p == s || isspace((unsigned char)p[-1]))) { *p = '\0'; return; }
+    }
+}
+
+static void track_hook(pid_t pid) {
+    if (g_hook_count == g_hook_cap) {
+        size_t cap = g_hook_cap ? g_hook_cap * 2 : 8;
+        pid_t* p = realloc(g_hook_pids, cap * sizeof(*p));
+        if (!p) return;     // left as a zombie until exit rather than reaping blindly
+        g_hook_pids = p;
+        g_hook_cap = cap;
+    }
+    g_hook_pids[g_hook_count++] = pid;
+}
+
+static void reap_hooks(void) {
+    for (size_t i = 0; i < g_hook_count;) {
+        pid_t r = waitpid(g_hook_pids[i], NULL, WNOHANG);
+        if (r == 0 || (r < 0 && errno == EINTR)) { i++; continue; }
+        g_hook_pids[i] = g_hook_pids[--g_hook_count];   // exited, or no longer ours (ECHILD)
+    }
+}
+
+static void free_rules(void) {
+    for (size_t i = 0; i < g_rule_count; i++) free(g_rules[i].hook);
+    free(g_rules);
+    free(g_ops);
+    free(g_field_rules);
+    free(g_dirty);
+    g_rules = NULL;
+    g_ops = NULL;
+    g_field_rules = NULL;
+    g_dirty = NULL;
+    g_rule_count = g_op_count = g_used_count = g_dirty_words = 0;
+    g_values_valid = 0;
+}
+
+/*
+ * Parse one non-empty line into the rule/op arrays (already grown by the
+ * caller). Returns 0, or -1 with *err pointing at a static message.
+ */
+static int parse_rule(char* line, Rule* rule, RuleOp* ops, size_t ops_room, const char** err) {
+    memset(rule, 0, sizeof(*rule));
+
+    char* arrow = strstr(line, "->");
+    if (arrow) {
+        *arrow = '\0';
+        char* hook = trim(arrow + 2);
+        if (strncmp(hook, "exec:", 5) == 0) rule->hook_kind = HOOK_EXEC;
+        else if (strncmp(hook, "fifo:", 5) == 0) rule->hook_kind = HOOK_FIFO;
+        else { *err = "hook must be exec:<command> or fifo:<path>"; return -1; }
+
+        hook = trim(hook + 5);
+        if (*hook == '\0') { *err = "empty hook"; return -1; }
+        rule->hook = strdup(hook);
+        if (!rule->hook) { *err = "out of memory"; return -1; }
+    }
+
+    char* colon = strchr(line, ':');
+    if (!colon) { *err = "missing 'name:'"; goto fail; }
+    *colon = '\0';
+
+    char* name = trim(line);
+    if (*name == '\0' || strlen(name) >= RULE_NAME_MAX) { *err = "bad rule name"; goto fail; }
+    memcpy(rule->name, name, strlen(name) + 1);
+
+    enum { EXPECT_FIELD, EXPECT_OP, EXPECT_VALUE, EXPECT_AND_OR_OPTION } want = EXPECT_FIELD;
+    RuleOp* op = NULL;
+    char* save = NULL;
+
+    for (char* tok = strtok_r(colon + 1, " \t", &save); tok; tok = strtok_r(NULL, " \t", &save)) {
+        switch (want) {
+            case EXPECT_FIELD: {
+                int f = stat_field_index(tok);
+                if (f < 0) { *err = "unknown field"; goto fail; }
+                if (rule->op_count >= ops_room) { *err = "too many terms"; goto fail; }
+                op = &ops[rule->op_count++];
+                op->field = (uint16_t)f;
+                want = EXPECT_OP;
+                break;
+            }
+            case EXPECT_OP: {
+                int o = parse_op(tok);
+                if (o < 0) { *err = "bad operator (use > >= < <= == !=, space separated)"; goto fail; }
+                op->op = (uint8_t)o;
+                want = EXPECT_VALUE;
+                break;
+            }
+            case EXPECT_VALUE: {
+                char* end;
+                op->raise = strtod(tok, &end);
+                if (end == tok) { *err = "bad threshold"; goto fail; }
+                op->clear = op->raise;
+                if (*end == ':') {
+                    char* c = end + 1;
+                    op->clear = strtod(c, &end);
+                    if (end == c) { *err = "bad clear value"; goto fail; }
+                }
+                if (*end != '\0') { *err = "bad threshold"; goto fail; }
+                want = EXPECT_AND_OR_OPTION;
+                break;
+            }
+            case EXPECT_AND_OR_OPTION: {
+                if (strcmp(tok, "and") == 0) { want = EXPECT_FIELD; break; }
+
+                uint64_t* dst = NULL;
+                if (strcmp(tok, "for") == 0) dst = &rule->for_ns;
+                else if (strcmp(tok, "hold") == 0) dst = &rule->hold_ns;
+                else if (strcmp(tok, "cooldown") == 0) dst = &rule->cooldown_ns;
+                else { *err = "expected and/for/hold/cooldown"; goto fail; }
+
+                char* v = strtok_r(NULL, " \t", &save);
+                if (!v || parse_duration_ns(v, dst) != 0) { *err = "bad duration"; goto fail; }
+                break;
+            }
+        }
+    }
+
+    if (want != EXPECT_AND_OR_OPTION) { *err = "incomplete condition"; goto fail; }
+    return 0;
+
+fail:
+    free(rule->hook);
+    rule->hook = NULL;
+    return -1;
+}
+
+// build the field -> rule index and the list of fields worth reading each tick
+static int build_index(void) {
+    uint32_t counts[STAT_FIELD_MAX] = {0};
+    size_t total = 0;
+
+    for (size_t r = 0; r < g_rule_count; r++) {
+        const Rule* rule = &g_rules[r];
+        for (uint32_t i = 0; i < rule->op_count; i++) {
+            uint16_t f = g_ops[rule->first_op + i].field;
+            int seen = 0;
+            for (uint32_t j = 0; j < i; j++) seen |= g_ops[rule->first_op + j].field == f;
+            if (!seen) { counts[f]++; total++; }
+        }
+    }
+
+    g_field_rules = malloc((total ? total : 1) * sizeof(*g_field_rules));
+    g_dirty_words = (g_rule_count + 63) / 64;
+    g_dirty = calloc(g_dirty_words ? g_dirty_words : 1, sizeof(*g_dirty));
+    if (!g_field_rules || !g_dirty) return -1;
+
+    g_used_count = 0;
+    g_field_first[0] = 0;
+    for (size_t f = 0; f < STAT_FIELD_MAX; f++) {
+        g_field_first[f + 1] = g_field_first[f] + counts[f];
+        if (counts[f]) g_used_fields[g_used_count++] = (uint16_t)f;
+    }
+
+    uint32_t fill[STAT_FIELD_MAX];
+    memcpy(fill, g_field_first, sizeof(fill));
+    for (size_t r = 0; r < g_rule_count; r++) {
+        const Rule* rule = &g_rules[r];
+        for (uint32_t i = 0; i < rule->op_count; i++) {
+            uint16_t f = g_ops[rule->first_op + i].field;
+            int seen = 0;
+            for (uint32_t j = 0; j < i; j++) seen |= g_ops[rule->first_op + j].field == f;
+            if (!seen) g_field_rules[fill[f]++] = (uint32_t)r;
+        }
+    }
+    return 0;
+}
+
+static void run_hook(Rule* rule, const char* state, uint64_t now_ns) {
+    if (rule->hook_kind == HOOK_NONE) return;
+
+    const RuleOp* first = &g_ops[rule->first_op];
+    char value[32];
+    snprintf(value, sizeof(value), "%.2f", g_values[first->field]);
+
+    if (rule->hook_kind == HOOK_EXEC) {
+        // the environment is built before fork(): other threads may hold the malloc lock
+        char env_name[64], env_state[32], env_value[48];
+        snprintf(env_name, sizeof(env_name), "HW_ALERT_NAME=%s", rule->name);
+        snprintf(env_state, sizeof(env_state), "HW_ALERT_STATE=%s", state);
+        snprintf(env_value, sizeof(env_value), "HW_ALERT_VALUE=%s", value);
+
+        size_t n = 0;
+        while (environ[n]) n++;
+        char** envp = malloc((n + 4) * sizeof(*envp));
+        if (!envp) return;
+        memcpy(envp, environ, n * sizeof(*envp));
+        envp[n] = env_name;
+        envp[n + 1] = env_state;
+        envp[n + 2] = env_value;
+        envp[n + 3] = NULL;
+
+        char* const argv[] = { "sh", "-c", rule->hook, NULL };
+        pid_t pid = fork();
+        if (pid == 0) {
+            execve("/bin/sh", argv, envp);
+            _exit(127);
+        }
+        if (pid > 0) track_hook(pid);
+        if (pid < 0) fprintf(stderr, "rules: fork for '%s' failed: %s\n", rule->name, strerror(errno));
+        free(envp);
+    } else {
+        // no reader -> ENXIO, the event is simply dropped
+        int fd = open(rule->hook, O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd >= 0) {
+            char line[128];
+            int n = snprintf(line, sizeof(line), "%s %s %s=%s\n", state, rule->name,
+                             stat_fields(NULL)[first->field].name, value);
+            if (n > 0 && write(fd, line, (size_t)n < sizeof(line) ? (size_t)n : sizeof(line) - 1) < 0) {
+                // reader too slow, pipe full: drop
+            }
+            close(fd);
+        }
+    }
+
+    rule->last_hook_ns = now_ns;
+    rule->hooked = 1;
+}
+
+static int rule_holds(const Rule* rule) {
+    const RuleOp* op = &g_ops[rule->first_op];
+    int firing = rule->state == RULE_FIRING;
+    for (uint32_t i = 0; i < rule->op_count; i++, op++) {
+        if (!compare(op->op, g_values[op->field], firing ? op->clear : op->raise)) return 0;
+    }
+    return 1;
+}
+
+/*
+ * Advance one rule's state machine.
+ * @return 1 if it is waiting on a timer and must be looked at next tick too
+ */
+static int step_rule(Rule* rule, uint64_t now_ns) {
+    int holds = rule_holds(rule);
+
+    switch (rule->state) {
+        case RULE_IDLE:
+            if (!holds) return 0;
+            rule->state = RULE_PENDING;
+            rule->pending_since_ns = now_ns;
+            // fall through - with for 0 it fires right away
+        case RULE_PENDING:
+            if (!holds) { rule->state = RULE_IDLE; return 0; }
+            if (now_ns - rule->pending_since_ns < rule->for_ns) return 1;
+
+            rule->state = RULE_FIRING;
+            rule->firing_since_ns = now_ns;
+            rule->acked = 0;
+            rule->notified = 0;
+            if (!rule->hooked || now_ns - rule->last_hook_ns >= rule->cooldown_ns) {
+                run_hook(rule, "firing", now_ns);
+                rule->notified = 1;
+            }
+            return now_ns - rule->firing_since_ns < rule->hold_ns;
+
+        case RULE_FIRING:
+            if (holds) return now_ns - rule->firing_since_ns < rule->hold_ns;
+            if (now_ns - rule->firing_since_ns < rule->hold_ns) return 1;
+
+            rule->state = RULE_IDLE;
+            if (rule->notified) run_hook(rule, "cleared", now_ns);
+            return 0;
+    }
+    return 0;
+}
+
+static void fill_alert(const Rule* rule, RuleAlert* out) {
+    const RuleOp* first = &g_ops[rule->first_op];
+    memset(out, 0, sizeof(*out));
+    memcpy(out->name, rule->name, sizeof(out->name));
+    snprintf(out->field, sizeof(out->field), "%s", stat_fields(NULL)[first->field].name);
+    snprintf(out->op, sizeof(out->op), "%s", g_op_text[first->op]);
+    out->threshold = first->raise;
+    out->value = g_values[first->field];
+    out->since_ns = rule->firing_since_ns;
+}
+
+/* =======================
+ * Public API
+ * ======================= */
+
+int rules_load(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) return -1;
+
+    free_rules();
+
+    size_t rule_cap = 0, op_cap = 0;
+    char line[512];
+    unsigned lineno = 0;
+
+    while (fgets(line, sizeof(line), f)) {
+        lineno++;
+
+        strip_comment(line);
+        char* text = trim(line);
+        if (*text == '\0') continue;
+
+        // a rule can have at most one term per 4 tokens; grow for the worst case of this line
+        size_t room = strlen(text) / 4 + 1;
+        if (g_rule_count == rule_cap || g_op_count + room > op_cap) {
+            size_t rc = rule_cap ? rule_cap * 2 : 16;
+            size_t oc = op_cap ? op_cap * 2 : 64;
+            while (oc < g_op_count + room) oc *= 2;
+            Rule* r = realloc(g_rules, rc * sizeof(*r));
+            if (r) { g_rules = r; rule_cap = rc; }
+            RuleOp* o = realloc(g_ops, oc * sizeof(*o));
+            if (o) { g_ops = o; op_cap = oc; }
+            if (!r || !o) break;
+        }
+
+        Rule* rule = &g_rules[g_rule_count];
+        const char* err = NULL;
+        if (parse_rule(text, rule, &g_ops[g_op_count], room, &err) != 0) {
+            fprintf(stderr, "%s:%u: %s\n", path, lineno, err);
+            continue;
+        }
+
+        rule->first_op = (uint32_t)g_op_count;
+        g_op_count += rule->op_count;
+        g_rule_count++;
+    }
+
+    fclose(f);
+
+    if (build_index() != 0) {
+        free_rules();
+        return -1;
+    }
+    return (int)g_rule_count;
+}
+
+void rules_evaluate(const HardwareStats* s, uint64_t now_ns) {
+    // exec hooks are fire-and-forget; collect whatever finished
+    reap_hooks();
+
+    if (g_rule_count == 0) return;
+
+    const StatField* fields = stat_fields(NULL);
+
+    for (size_t i = 0; i < g_used_count; i++) {
+        uint16_t f = g_used_fields[i];
+        double v = stat_field_value(&fields[f], s);
+        if (g_values_valid && memcmp(&v, &g_values[f], sizeof(v)) == 0) continue;
+
+        g_values[f] = v;
+        for (uint32_t k = g_field_first[f]; k < g_field_first[f + 1]; k++) {
+            uint32_t r = g_field_rules[k];
+            g_dirty[r >> 6] |= 1ULL << (r & 63);
+        }
+    }
+    g_values_valid = 1;
+
+    for (size_t w = 0; w < g_dirty_words; w++) {
+        uint64_t bits = g_dirty[w];
+        uint64_t keep = 0;
+
+        while (bits) {
+            unsigned b = (unsigned)__builtin_ctzll(bits);
+            bits &= bits - 1;
+            if (step_rule(&g_rules[w * 64 + b], now_ns)) keep |= 1ULL << b;
+        }
+        g_dirty[w] = keep;
+    }
+}
+
+size_t rules_count(void) {
+    return g_rule_count;
+}
+
+size_t rules_firing(RuleAlert* out, size_t max) {
+    size_t n = 0;
+    for (size_t r = 0; r < g_rule_count; r++) {
+        const Rule* rule = &g_rules[r];
+        if (rule->state != RULE_FIRING) continue;
+
+        // insertion by since_ns, newest first
+        size_t pos = n;
+        while (pos > 0 && out[pos - 1].since_ns < rule->firing_since_ns) pos--;
+        if (pos >= max) continue;
+        size_t last = n < max ? n : max - 1;
+        memmove(&out[pos + 1], &out[pos], (last - pos) * sizeof(*out));
+        fill_alert(rule, &out[pos]);
+        if (n < max) n++;
+    }
+    return n;
+}
+
+int rules_flash(RuleAlert* out) {
+    const Rule* best = NULL;
+    for (size_t r = 0; r < g_rule_count; r++) {
+        const Rule* rule = &g_rules[r];
+        if (rule->state != RULE_FIRING || rule->acked) continue;
+        if (!best || rule->firing_since_ns > best->firing_since_ns) best = rule;
+    }
+    if (!best) return 0;
+    fill_alert(best, out);
+    return 1;
+}
+
+void rules_acknowledge(void) {
+    for (size_t r = 0; r < g_rule_count; r++) {
+        if (g_rules[r].state == RULE_FIRING) g_rules[r].acked = 1;
+    }
+}
+
+void rules_deinit(void) {
+    free_rules();
+    reap_hooks();
+    free(g_hook_pids);
+    g_hook_pids = NULL;
+    g_hook_count = g_hook_cap = 0;
+}
@@ -0,0 +1,493 @@
+#define _DEFAULT_SOURCE
+#include "collectors/cgroup.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/* =======================
+ * Internal structures
+ * ======================= */
+
+#define CG_PATH_MAX  256
+#define CG_READ_MAX 4096
+#define CG_BENCH_DIR  "hw_monitoring_bench"
+#define CG_BENCH_TICKS 20
+#define CG_RETRY_TICKS 64       // how often files of a missing controller are looked for again
+#define CG_FD_MISSING  (-2)     // openat said ENOENT: controller not enabled for this cgroup
+
+enum {
+    CG_CPU_STAT = 0, CG_IO_STAT, CG_MEM_CURRENT, CG_MEM_EVENTS,
+    CG_PSI_CPU, CG_PSI_MEMORY, CG_PSI_IO, CG_NFILES
+};
+
+static const char* const g_file_names[CG_NFILES] = {
+    "cpu.stat", "io.stat", "memory.current", "memory.events",
+    "cpu.pressure", "memory.pressure", "io.pressure"
+};
+
+typedef struct {
+    int  dirfd;
+    int  fds[CG_NFILES];        // kept open and pread each tick; -1 not held, CG_FD_MISSING
+    int  wd;                    // inotify watch on this directory, -1 if none
+    char rel[CG_PATH_MAX];      // relative to the root, "" never appears (root is not tracked)
+    int  has_prev;
+    unsigned long long usage_usec;
+    unsigned long long rbytes;
+    unsigned long long wbytes;
+    CgroupStats stats;
+} CgEntry;
+
+static char   g_root[CG_PATH_MAX];
+static int    g_root_fd = -1;
+static int    g_root_wd = -1;
+static int    g_inotify_fd = -1;
+static int    g_initialized = 0;
+
+static CgEntry* g_entries = NULL;
+static size_t   g_count = 0;
+static size_t   g_cap = 0;
+
+static double g_last_s = 0.0;
+static char   g_buf[CG_READ_MAX];
+
+static size_t   g_held = 0;         // open per-file fds over all entries
+static size_t   g_held_max = 0;     // half of RLIMIT_NOFILE, the rest is left to everyone else
+static unsigned g_tick = 0;
+
+/* =======================
+ * Helpers
+ * ======================= */
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static const char* base_name(const char* rel) {
+    const char* slash = strrchr(rel, '/');
+    return slash ? slash + 1 : rel;
+}
+
+/*
+ * Read one of the entry's files into g_buf. The fd stays open and the next
+ * tick preads it again, as long as the process-wide budget allows; past it
+ * the file is opened for this read only. ENODEV/ENOENT: the cgroup is gone.
+ */
+static ssize_t read_file(CgEntry* e, int i) {
+    int fd = e->fds[i];
+    int held = fd >= 0;
+
+    if (!held) {
+        if (fd == CG_FD_MISSING && g_tick % CG_RETRY_TICKS != 0) { errno = ENOENT; return -1; }
+
+        fd = openat(e->dirfd, g_file_names[i], O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            if (errno == ENOENT) e->fds[i] = CG_FD_MISSING;
+            return -1;
+        }
+        if (g_held < g_held_max) {
+            e->fds[i] = fd;
+            g_held++;
+            held = 1;
+        } else {
+            e->fds[i] = -1;
+        }
+    }
+
+    ssize_t n = pread(fd, g_buf, sizeof(g_buf) - 1, 0);
+    int saved = errno;
+    if (!held) close(fd);
+    errno = saved;
+
+    if (n < 0) return -1;
+    g_buf[n] = '\0';
+    return n;
+}
+
+static void close_files(CgEntry* e) {
+    for (int i = 0; i < CG_NFILES; i++) {
+        if (e->fds[i] >= 0) {
+            close(e->fds[i]);
+            g_held--;
+        }
+        e->fds[i] = -1;
+    }
+}
+
+static unsigned long long parse_ull(const char* p) {
+    unsigned long long v = 0;
+    while (*p >= '0' && *p <= '9') v = v * 10u + (unsigned long long)(*p++ - '0');
+    return v;
+}
+
+// value of "key N" on its own line in a flat keyed file (cpu.stat, memory.events)
+static unsigned long long keyed_value(const char* buf, const char* key) {
+    size_t klen = strlen(key);
+    const char* p = buf;
+    while (p && *p) {
+        if (strncmp(p, key, klen) == 0 && p[klen] == ' ') return parse_ull(p + klen + 1);
+        p = strchr(p, '\n');
+        if (p) p++;
+    }
+    return 0;
+}
+
+// sum of "name=N" over every device line of io.stat
+static unsigned long long io_sum(const char* buf, const char* token) {
+    size_t tlen = strlen(token);
+    unsigned long long sum = 0;
+    const char* p = buf;
+    while ((p = strstr(p, token)) != NULL) {
+        if (p == buf || p[-1] == ' ') sum += parse_ull(p + tlen);
+        p += tlen;
+    }
+    return sum;
+}
+
+static double some_avg10(CgEntry* e, int i) {
+    if (read_file(e, i) < 0) return 0.0;
+    const char* p = strstr(g_buf, "some avg10=");
+    return p ? strtod(p + 11, NULL) : 0.0;
+}
+
+static CgEntry* find_by_rel(const char* rel) {
+    for (size_t i = 0; i < g_count; i++) {
+        if (strcmp(g_entries[i].rel, rel) == 0) return &g_entries[i];
+    }
+    return NULL;
+}
+
+static const char* rel_by_wd(int wd) {
+    if (wd == g_root_wd) return "";
+    for (size_t i = 0; i < g_count; i++) {
+        if (g_entries[i].wd == wd) return g_entries[i].rel;
+    }
+    return NULL;
+}
+
+static int join(char out[CG_PATH_MAX], const char* parent, const char* name) {
+    int n = parent[0] ? snprintf(out, CG_PATH_MAX, "%s/%s", parent, name)
+                      : snprintf(out, CG_PATH_MAX, "%s", name);
+    return (n < 0 || n >= CG_PATH_MAX) ? -1 : 0;
+}
+
+static int add_watch(const char* rel) {
+    if (g_inotify_fd < 0) return -1;
+    char full[CG_PATH_MAX * 2];
+    snprintf(full, sizeof(full), "%s/%s", g_root, rel);
+    return inotify_add_watch(g_inotify_fd, full, IN_CREATE | IN_DELETE | IN_ONLYDIR);
+}
+
+static void drop_entry(size_t i) {
+    CgEntry* e = &g_entries[i];
+    close_files(e);
+    if (e->dirfd >= 0) close(e->dirfd);
+    if (e->wd >= 0 && g_inotify_fd >= 0) inotify_rm_watch(g_inotify_fd, e->wd); // may already be gone
+    g_entries[i] = g_entries[--g_count];
+}
+
+static void remove_subtree(const char* rel) {
+    char key[CG_PATH_MAX];
+    snprintf(key, sizeof(key), "%s", rel); // rel may point into an entry we are about to drop
+    size_t klen = strlen(key);
+
+    size_t i = 0;
+    while (i < g_count) {
+        const char* r = g_entries[i].rel;
+        if (strncmp(r, key, klen) == 0 && (r[klen] == '\0' || r[klen] == '/')) {
+            drop_entry(i);
+            continue;
+        }
+        i++;
+    }
+}
+
+// track rel and every cgroup below it; dirs created before the watch was in place are picked up by the walk
+static void add_tree(const char* rel, int check_existing) {
+    if (check_existing && find_by_rel(rel)) return;
+
+    int dfd = openat(g_root_fd, rel, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dfd < 0) return; // already removed again
+
+    if (g_count == g_cap) {
+        size_t cap = g_cap ? g_cap * 2 : 64;
+        CgEntry* bigger = realloc(g_entries, cap * sizeof(*bigger));
+        if (!bigger) { close(dfd); return; }
+        g_entries = bigger;
+        g_cap = cap;
+    }
+
+    CgEntry* e = &g_entries[g_count++];
+    memset(e, 0, sizeof(*e));
+    e->dirfd = dfd;
+    for (int i = 0; i < CG_NFILES; i++) e->fds[i] = -1;
+    snprintf(e->rel, sizeof(e->rel), "%s", rel);
+    snprintf(e->stats.name, sizeof(e->stats.name), "%s", base_name(rel));
+    e->wd = add_watch(rel);
+
+    int lfd = dup(dfd);
+    if (lfd < 0) return;
+    DIR* d = fdopendir(lfd);
+    if (!d) { close(lfd); return; }
+
+    struct dirent* de;
+    while ((de = readdir(d)) != NULL) {
+        if (de->d_type != DT_DIR || de->d_name[0] == '.') continue;
+        char child[CG_PATH_MAX];
+        if (join(child, rel, de->d_name) == 0) add_tree(child, check_existing);
+        // e may be stale after the recursive realloc; nothing below touches it
+    }
+    closedir(d);
+}
+
+static void walk_root(void) {
+    int lfd = dup(g_root_fd);
+    if (lfd < 0) return;
+    DIR* d = fdopendir(lfd);
+    if (!d) { close(lfd); return; }
+
+    struct dirent* de;
+    while ((de = readdir(d)) != NULL) {
+        if (de->d_type != DT_DIR || de->d_name[0] == '.') continue;
+        add_tree(de->d_name, 0);
+    }
+    closedir(d);
+}
+
+static void drain_events(void) {
+    if (g_inotify_fd < 0) return;
+
+    _Alignas(struct inotify_event) char buf[4096];
+
+    for (;;) {
+        ssize_t n = read(g_inotify_fd, buf, sizeof(buf));
+        if (n <= 0) return; // EAGAIN: queue drained
+
+        for (char* p = buf; p < buf + n; ) {
+            const struct inotify_event* ev = (const struct inotify_event*)p;
+            p += sizeof(*ev) + ev->len;
+
+            if (ev->mask & IN_Q_OVERFLOW) {
+                // lost events: start over from a fresh walk
+                while (g_count > 0) drop_entry(g_count - 1);
+                walk_root();
+                continue;
+            }
+
+            if (!(ev->mask & IN_ISDIR) || ev->len == 0) continue;
+
+            const char* parent = rel_by_wd(ev->wd);
+            char child[CG_PATH_MAX];
+            if (!parent || join(child, parent, ev->name) != 0) continue;
+
+            if (ev->mask & IN_CREATE) add_tree(child, 1);
+            else if (ev->mask & IN_DELETE) remove_subtree(child);
+        }
+    }
+}
+
+// 0 ok, -1 cgroup is gone
+static int read_entry(CgEntry* e, double dt) {
+    CgroupStats* s = &e->stats;
+
+    if (read_file(e, CG_CPU_STAT) < 0) return (errno == ENOENT || errno == ENODEV) ? -1 : 0;
+    unsigned long long usage = keyed_value(g_buf, "usage_usec");
+
+    unsigned long long rbytes = 0, wbytes = 0;
+    if (read_file(e, CG_IO_STAT) >= 0) {
+        rbytes = io_sum(g_buf, "rbytes=");
+        wbytes = io_sum(g_buf, "wbytes=");
+    }
+
+    s->memory_current = (read_file(e, CG_MEM_CURRENT) >= 0) ? parse_ull(g_buf) : 0;
+
+    if (read_file(e, CG_MEM_EVENTS) >= 0) {
+        s->mem_high = keyed_value(g_buf, "high");
+        s->mem_max  = keyed_value(g_buf, "max");
+        s->oom      = keyed_value(g_buf, "oom");
+        s->oom_kill = keyed_value(g_buf, "oom_kill");
+    }
+
+    s->psi_cpu_some_avg10    = some_avg10(e, CG_PSI_CPU);
+    s->psi_memory_some_avg10 = some_avg10(e, CG_PSI_MEMORY);
+    s->psi_io_some_avg10     = some_avg10(e, CG_PSI_IO);
+
+    if (e->has_prev && dt > 0.0) {
+        s->cpu_percent          = (usage  >= e->usage_usec) ? 100.0 * (double)(usage - e->usage_usec) / (dt * 1e6) : 0.0;
+        s->io_read_bytes_per_s  = (rbytes >= e->rbytes) ? (double)(rbytes - e->rbytes) / dt : 0.0;
+        s->io_write_bytes_per_s = (wbytes >= e->wbytes) ? (double)(wbytes - e->wbytes) / dt : 0.0;
+    } else {
+        s->cpu_percent = s->io_read_bytes_per_s = s->io_write_bytes_per_s = 0.0;
+    }
+
+    e->usage_usec = usage;
+    e->rbytes = rbytes;
+    e->wbytes = wbytes;
+    e->has_prev = 1;
+    return 0;
+}
+
+static double bench_tick(size_t* count) {
+    double t = now_s();
+    cgroup_sample(NULL, count);
+    return (now_s() - t) * 1e3;
+}
+
+static void bench_cleanup(unsigned n) {
+    char rel[CG_PATH_MAX];
+    for (unsigned i = 0; i < n; i++) {
+        snprintf(rel, sizeof(rel), CG_BENCH_DIR "/cg%u", i);
+        unlinkat(g_root_fd, rel, AT_REMOVEDIR);
+    }
+    unlinkat(g_root_fd, CG_BENCH_DIR, AT_REMOVEDIR);
+}
+
+/* =======================
+ * Public API
+ * ======================= */
+
+int cgroup_init(const char* root) {
+    if (g_initialized) cgroup_deinit();
+
+    if (!root) {
+        root = (access("/sys/fs/cgroup/cgroup.controllers", F_OK) == 0) ? "/sys/fs/cgroup"
+                                                                       : "/sys/fs/cgroup/unified";
+    }
+    snprintf(g_root, sizeof(g_root), "%s", root);
+
+    struct rlimit rl;
+    g_held_max = (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY) ? (size_t)rl.rlim_cur / 2 : 512;
+
+    g_root_fd = open(g_root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (g_root_fd < 0) return -1;
+
+    if (faccessat(g_root_fd, "cgroup.controllers", F_OK, 0) != 0) {
+        close(g_root_fd);
+        g_root_fd = -1;
+        return -1;
+    }
+
+    // without inotify we still work, just never notice new cgroups
+    g_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (g_inotify_fd >= 0)
+        g_root_wd = inotify_add_watch(g_inotify_fd, g_root, IN_CREATE | IN_DELETE | IN_ONLYDIR);
+
+    walk_root();
+    g_initialized = 1;
+    return 0;
+}
+
+int cgroup_sample(CgroupStats* top_out, size_t* count_out) {
+    if (!g_initialized && cgroup_init(NULL) != 0) return -1;
+
+    drain_events();
+
+    double t  = now_s();
+    double dt = (g_last_s > 0.0) ? t - g_last_s : 0.0;
+    g_last_s  = t;
+    g_tick++;
+
+    size_t best = 0;
+    size_t i = 0;
+    while (i < g_count) {
+        if (read_entry(&g_entries[i], dt) != 0) {
+            drop_entry(i); // removed before its inotify event arrived; the last entry moves into i
+            continue;
+        }
+        if (g_entries[i].stats.cpu_percent > g_entries[best].stats.cpu_percent) best = i;
+        i++;
+    }
+
+    if (top_out) {
+        if (g_count > 0) *top_out = g_entries[best].stats;
+        else memset(top_out, 0, sizeof(*top_out));
+    }
+    if (count_out) *count_out = g_count;
+    return 0;
+}
+
+size_t cgroup_snapshot(CgroupStats* out, size_t max) {
+    if (!out) return 0;
+    size_t n = 0;
+    for (; n < g_count && n < max; n++) out[n] = g_entries[n].stats;
+    return n;
+}
+
+void cgroup_deinit(void) {
+    while (g_count > 0) drop_entry(g_count - 1);
+    free(g_entries);
+    g_entries = NULL;
+    g_cap = 0;
+
+    if (g_inotify_fd >= 0) close(g_inotify_fd);
+    if (g_root_fd >= 0) close(g_root_fd);
+    g_inotify_fd = g_root_fd = g_root_wd = -1;
+    g_initialized = 0;
+    g_last_s = 0.0;
+}
+
+int cgroup_benchmark(unsigned n) {
+    size_t base = 0;
+    if (cgroup_init(NULL) != 0 || cgroup_sample(NULL, &base) != 0) {
+        fprintf(stderr, "cgroup bench: no cgroup v2 hierarchy\n");
+        return 1;
+    }
+
+    bench_cleanup(n); // leftovers of an interrupted run
+    drain_events();
+
+    if (mkdirat(g_root_fd, CG_BENCH_DIR, 0755) != 0) {
+        fprintf(stderr, "cgroup bench: mkdir %s/%s: %s\n", g_root, CG_BENCH_DIR, strerror(errno));
+        cgroup_deinit();
+        return 1;
+    }
+    // the parent must be tracked (and watched) before its children appear
+    bench_tick(NULL);
+
+    int rc = 0;
+    char rel[CG_PATH_MAX];
+    for (unsigned i = 0; i < n && rc == 0; i++) {
+        snprintf(rel, sizeof(rel), CG_BENCH_DIR "/cg%u", i);
+        if (mkdirat(g_root_fd, rel, 0755) != 0) {
+            fprintf(stderr, "cgroup bench: mkdir after %u cgroups: %s\n", i, strerror(errno));
+            rc = 1;
+        }
+    }
+
+    if (rc == 0) {
+        size_t count = 0;
+        double create = bench_tick(&count);
+
+        double best = 0.0, sum = 0.0;
+        for (int i = 0; i < CG_BENCH_TICKS; i++) {
+            double ms = bench_tick(&count);
+            if (i == 0 || ms < best) best = ms;
+            sum += ms;
+        }
+
+        bench_cleanup(n);
+        size_t left = 0;
+        double removed = bench_tick(&left);
+
+        printf("cgroup bench: %s, %zu cgroups tracked (%zu before)\n", g_root, count, base);
+        printf("  tick applying %u creates  %8.2f ms\n", n, create);
+        printf("  steady tick, best of %d   %8.2f ms  (mean %.2f, %.1f us/cgroup)\n",
+               CG_BENCH_TICKS, best, sum / CG_BENCH_TICKS, best * 1e3 / (double)count);
+        printf("  tick applying %u removes  %8.2f ms  (%zu left)\n", n, removed, left);
+    } else {
+        bench_cleanup(n);
+    }
+
+    cgroup_deinit();
+    return rc;
+}
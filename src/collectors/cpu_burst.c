@@ -0,0 +1,398 @@
+#define _GNU_SOURCE
+#include "collectors/cpu_burst.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* =======================
+ * Internal structures
+ * ======================= */
+
+#define RING_SLOTS      256             // 256 ms of headroom at 1 kHz
+#define RING_MASK       (RING_SLOTS - 1)
+#define CONSUMER_POLL_MS 50              // ring covers 256 ms at 1 kHz
+#define HIST_BINS       101             // 0..100 %
+
+typedef struct {
+    uint64_t t_ns;
+    uint32_t core_count;
+    uint64_t busy[CPU_BURST_MAX_CORES];     // USER_HZ ticks
+    uint64_t total[CPU_BURST_MAX_CORES];
+} BurstSample;
+
+static BurstSample g_ring[RING_SLOTS];
+static _Alignas(64) _Atomic uint64_t g_head = 0;   // written by the sampler only
+static _Alignas(64) _Atomic uint64_t g_tail = 0;   // written by the consumer only
+
+// sampler -> consumer counters, relaxed: only read for the overhead report
+static _Atomic uint64_t g_samples = 0;
+static _Atomic uint64_t g_dropped = 0;
+static _Atomic uint64_t g_missed = 0;
+static _Atomic uint64_t g_read_ns = 0;
+static _Atomic uint64_t g_sampler_cpu_ns = 0;
+
+static _Atomic uint64_t g_period_ns = 0;           // consumer lowers the rate when over budget
+static atomic_int g_running = 0;
+static pthread_t g_sampler, g_consumer;
+static unsigned g_hz, g_slice_ms, g_window_ms;
+
+// last published window, guarded by g_lock (written once per window)
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static CpuBurstWindow g_latest;
+static CpuBurstOverhead g_overhead;
+static int g_have_latest = 0;
+
+// consumer-private aggregation state
+typedef struct {
+    uint64_t busy, total;       // counters at the start of the current slice
+    float    min, max;
+    double   sum;
+    uint32_t n;
+    uint16_t hist[HIST_BINS];
+} CoreAccum;
+
+static CoreAccum g_acc[CPU_BURST_MAX_CORES];
+
+/* =======================
+ * Helpers
+ * ======================= */
+
+static uint64_t clock_ns(clockid_t id) {
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static const char* parse_u64(const char* p, const char* end, uint64_t* out) {
+    while (p < end && *p == ' ') p++;
+    uint64_t v = 0;
+    while (p < end && (unsigned)(*p - '0') < 10) v = v * 10 + (uint64_t)(*p++ - '0');
+    *out = v;
+    return p;
+}
+
+/*
+ * "cpuN user nice system idle iowait irq softirq steal guest guest_nice".
+ * guest time is already part of user, so it is not added again.
+ * Only complete lines are used; parsing stops at the first non-cpu line.
+ */
+static uint32_t parse_proc_stat(const char* buf, size_t len, BurstSample* s) {
+    const char* p = buf;
+    const char* end = buf + len;
+    uint32_t count = 0;
+
+    memset(s->total, 0, sizeof(s->total));
+    memset(s->busy, 0, sizeof(s->busy));
+
+    while (p < end) {
+        const char* nl = memchr(p, '\n', (size_t)(end - p));
+        if (!nl) break;
+        if (end - p < 4 || memcmp(p, "cpu", 3) != 0) break;
+
+        if ((unsigned)(p[3] - '0') < 10) {
+            uint64_t idx;
+            const char* q = parse_u64(p + 3, nl, &idx);
+            uint64_t f[8];
+            for (int i = 0; i < 8; i++) q = parse_u64(q, nl, &f[i]);
+
+            if (idx < CPU_BURST_MAX_CORES) {
+                uint64_t busy = f[0] + f[1] + f[2] + f[5] + f[6] + f[7];
+                s->busy[idx]  = busy;
+                s->total[idx] = busy + f[3] + f[4];
+                if (idx + 1 > count) count = (uint32_t)idx + 1;
+            }
+        }
+        p = nl + 1;
+    }
+    return count;
+}
+
+/* =======================
+ * Sampler thread
+ * ======================= */
+
+static void* sampler_main(void* arg) {
+    (void)arg;
+
+    int fd = open("/proc/stat", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return NULL;
+
+    // the cpu lines come first; the (possibly huge) intr line is cut off
+    static char buf[(CPU_BURST_MAX_CORES + 1) * 160];
+
+    // thread CPU time is a syscall, not vDSO: read it once per slice rather than per sample
+    uint64_t slice_ns = (uint64_t)g_slice_ms * 1000000ULL;
+    uint64_t next = clock_ns(CLOCK_MONOTONIC);
+    uint64_t cputime_next = next;
+
+    while (atomic_load_explicit(&g_running, memory_order_relaxed)) {
+        uint64_t period = atomic_load_explicit(&g_period_ns, memory_order_relaxed);
+        next += period;
+        struct timespec ts = { (time_t)(next / 1000000000ULL), (long)(next % 1000000000ULL) };
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {}
+
+        uint64_t t0 = clock_ns(CLOCK_MONOTONIC);
+        if (t0 >= next + period) {
+            // overslept: skip the ticks instead of bursting to catch up
+            atomic_fetch_add_explicit(&g_missed, (t0 - next) / period, memory_order_relaxed);
+            next = t0;
+        }
+
+        uint64_t head = atomic_load_explicit(&g_head, memory_order_relaxed);
+        uint64_t tail = atomic_load_explicit(&g_tail, memory_order_acquire);
+        if (head - tail >= RING_SLOTS) {
+            atomic_fetch_add_explicit(&g_dropped, 1, memory_order_relaxed);
+            continue;
+        }
+
+        ssize_t len = pread(fd, buf, sizeof(buf), 0);
+        if (len <= 0) continue;
+
+        BurstSample* s = &g_ring[head & RING_MASK];
+        s->core_count = parse_proc_stat(buf, (size_t)len, s);
+        s->t_ns = t0;
+        atomic_store_explicit(&g_head, head + 1, memory_order_release);
+
+        atomic_fetch_add_explicit(&g_read_ns, clock_ns(CLOCK_MONOTONIC) - t0, memory_order_relaxed);
+        atomic_fetch_add_explicit(&g_samples, 1, memory_order_relaxed);
+
+        if (t0 >= cputime_next) {
+            atomic_store_explicit(&g_sampler_cpu_ns, clock_ns(CLOCK_THREAD_CPUTIME_ID), memory_order_relaxed);
+            cputime_next = t0 + slice_ns;
+        }
+    }
+
+    close(fd);
+    return NULL;
+}
+
+/* =======================
+ * Consumer thread
+ * ======================= */
+
+static void reset_window(void) {
+    for (int c = 0; c < CPU_BURST_MAX_CORES; c++) {
+        CoreAccum* a = &g_acc[c];
+        a->min = 100.0f;
+        a->max = 0.0f;
+        a->sum = 0.0;
+        a->n = 0;
+        memset(a->hist, 0, sizeof(a->hist));
+    }
+}
+
+static float hist_quantile(const CoreAccum* a, double q) {
+    if (a->n == 0) return 0.0f;
+    uint32_t rank = (uint32_t)(q * (double)(a->n - 1)) + 1;
+    uint32_t seen = 0;
+    for (int b = 0; b < HIST_BINS; b++) {
+        seen += a->hist[b];
+        if (seen >= rank) return (float)b;
+    }
+    return 100.0f;
+}
+
+typedef struct {
+    uint64_t wall_ns, samples, read_ns, sampler_cpu_ns, consumer_cpu_ns;
+} OverheadMark;
+
+static void publish(uint64_t end_ns, uint32_t core_count, unsigned slices, OverheadMark* mark) {
+    CpuBurstWindow w;
+    memset(&w, 0, sizeof(w));
+    w.end_ns = end_ns;
+    w.window_ms = g_window_ms;
+    w.slice_ms = g_slice_ms;
+    w.slices = slices;
+    w.core_count = core_count;
+    w.hottest_core = -1;
+
+    for (uint32_t c = 0; c < core_count; c++) {
+        const CoreAccum* a = &g_acc[c];
+        CpuBurstCore* o = &w.core[c];
+        if (a->n == 0) continue;
+        o->min  = a->min;
+        o->max  = a->max;
+        o->mean = (float)(a->sum / a->n);
+        o->p50  = hist_quantile(a, 0.50);
+        o->p95  = hist_quantile(a, 0.95);
+        o->p99  = hist_quantile(a, 0.99);
+        if (w.hottest_core < 0 || o->p99 > w.core[w.hottest_core].p99) w.hottest_core = (int)c;
+    }
+
+    OverheadMark now = {
+        clock_ns(CLOCK_MONOTONIC),
+        atomic_load_explicit(&g_samples, memory_order_relaxed),
+        atomic_load_explicit(&g_read_ns, memory_order_relaxed),
+        atomic_load_explicit(&g_sampler_cpu_ns, memory_order_relaxed),
+        clock_ns(CLOCK_THREAD_CPUTIME_ID),
+    };
+
+    CpuBurstOverhead oh;
+    memset(&oh, 0, sizeof(oh));
+    oh.target_hz = g_hz;
+    oh.samples = now.samples;
+    oh.dropped = atomic_load_explicit(&g_dropped, memory_order_relaxed);
+    oh.missed_ticks = atomic_load_explicit(&g_missed, memory_order_relaxed);
+
+    double wall = (double)(now.wall_ns - mark->wall_ns);
+    if (wall > 0.0 && mark->wall_ns != 0) {
+        uint64_t ds = now.samples - mark->samples;
+        oh.actual_hz = (double)ds * 1e9 / wall;
+        oh.read_us = ds ? (double)(now.read_ns - mark->read_ns) / (double)ds / 1e3 : 0.0;
+        oh.sampler_cpu_percent = 100.0 * (double)(now.sampler_cpu_ns - mark->sampler_cpu_ns) / wall;
+        oh.consumer_cpu_percent = 100.0 * (double)(now.consumer_cpu_ns - mark->consumer_cpu_ns) / wall;
+    }
+    *mark = now;
+
+    // keep the sampler inside its budget: scale the rate by how far over it is,
+    // creep back towards the target once there is room again
+    uint64_t period = atomic_load_explicit(&g_period_ns, memory_order_relaxed);
+    double hz = 1e9 / (double)period;
+    if (oh.sampler_cpu_percent > CPU_BURST_BUDGET_PERCENT) {
+        hz *= 0.9 * CPU_BURST_BUDGET_PERCENT / oh.sampler_cpu_percent;
+    } else if (oh.sampler_cpu_percent > 0.0 && oh.sampler_cpu_percent < 0.6 * CPU_BURST_BUDGET_PERCENT) {
+        hz *= 1.25;
+    }
+    if (hz > g_hz) hz = g_hz;
+    if (hz < 100.0) hz = 100.0;
+    atomic_store_explicit(&g_period_ns, (uint64_t)(1e9 / hz), memory_order_relaxed);
+    oh.effective_hz = (unsigned)(hz + 0.5);
+
+    pthread_mutex_lock(&g_lock);
+    g_latest = w;
+    g_overhead = oh;
+    g_have_latest = 1;
+    pthread_mutex_unlock(&g_lock);
+}
+
+static void* consumer_main(void* arg) {
+    (void)arg;
+
+    uint64_t slice_ns = (uint64_t)g_slice_ms * 1000000ULL;
+    uint64_t window_ns = (uint64_t)g_window_ms * 1000000ULL;
+    uint64_t slice_start = 0, window_start = 0;
+    uint32_t core_count = 0;
+    unsigned slices = 0;
+    OverheadMark mark;
+    memset(&mark, 0, sizeof(mark));
+
+    reset_window();
+
+    while (atomic_load_explicit(&g_running, memory_order_relaxed)) {
+        struct timespec ts = { 0, CONSUMER_POLL_MS * 1000000L };
+        nanosleep(&ts, NULL);
+
+        uint64_t tail = atomic_load_explicit(&g_tail, memory_order_relaxed);
+        uint64_t head = atomic_load_explicit(&g_head, memory_order_acquire);
+
+        for (; tail != head; tail++) {
+            const BurstSample* s = &g_ring[tail & RING_MASK];
+
+            if (slice_start == 0) {
+                for (uint32_t c = 0; c < s->core_count; c++) {
+                    g_acc[c].busy = s->busy[c];
+                    g_acc[c].total = s->total[c];
+                }
+                core_count = s->core_count;
+                slice_start = window_start = s->t_ns;
+                continue;
+            }
+
+            if (s->t_ns - slice_start >= slice_ns) {
+                if (s->core_count > core_count) core_count = s->core_count;
+
+                for (uint32_t c = 0; c < s->core_count; c++) {
+                    CoreAccum* a = &g_acc[c];
+                    // offline cores read as 0; hotplugged ones start a fresh baseline
+                    if (s->total[c] > a->total && s->busy[c] >= a->busy) {
+                        float u = 100.0f * (float)(s->busy[c] - a->busy) / (float)(s->total[c] - a->total);
+                        if (u > 100.0f) u = 100.0f;
+                        if (u < a->min) a->min = u;
+                        if (u > a->max) a->max = u;
+                        a->sum += u;
+                        a->n++;
+                        a->hist[(int)(u + 0.5f)]++;
+                    }
+                    a->busy = s->busy[c];
+                    a->total = s->total[c];
+                }
+                slice_start = s->t_ns;
+                slices++;
+            }
+
+            if (s->t_ns - window_start >= window_ns) {
+                publish(s->t_ns, core_count, slices, &mark);
+                reset_window();
+                slices = 0;
+                window_start = s->t_ns;
+            }
+        }
+
+        // raw samples are gone once the slot is released
+        atomic_store_explicit(&g_tail, tail, memory_order_release);
+    }
+    return NULL;
+}
+
+/* =======================
+ * Public API
+ * ======================= */
+
+int cpu_burst_start(unsigned hz, unsigned slice_ms, unsigned window_ms) {
+    if (atomic_load(&g_running)) return 0;
+    if (hz < 100 || hz > 1000 || slice_ms < 10 || window_ms < slice_ms) return -1;
+
+    g_hz = hz;
+    atomic_store(&g_period_ns, 1000000000ULL / hz);
+    g_slice_ms = slice_ms;
+    g_window_ms = window_ms;
+    atomic_store(&g_head, 0);
+    atomic_store(&g_tail, 0);
+    atomic_store(&g_samples, 0);
+    atomic_store(&g_dropped, 0);
+    atomic_store(&g_missed, 0);
+    atomic_store(&g_read_ns, 0);
+    g_have_latest = 0;
+
+    atomic_store(&g_running, 1);
+
+    if (pthread_create(&g_sampler, NULL, sampler_main, NULL) != 0) {
+        atomic_store(&g_running, 0);
+        return -1;
+    }
+    if (pthread_create(&g_consumer, NULL, consumer_main, NULL) != 0) {
+        atomic_store(&g_running, 0);
+        pthread_join(g_sampler, NULL);
+        return -1;
+    }
+    return 0;
+}
+
+int cpu_burst_running(void) {
+    return atomic_load(&g_running);
+}
+
+int cpu_burst_latest(CpuBurstWindow* out) {
+    pthread_mutex_lock(&g_lock);
+    int ok = g_have_latest;
+    if (ok) *out = g_latest;
+    pthread_mutex_unlock(&g_lock);
+    return ok ? 0 : -1;
+}
+
+void cpu_burst_overhead(CpuBurstOverhead* out) {
+    pthread_mutex_lock(&g_lock);
+    *out = g_overhead;
+    pthread_mutex_unlock(&g_lock);
+}
+
+void cpu_burst_stop(void) {
+    if (!atomic_exchange(&g_running, 0)) return;
+    pthread_join(g_sampler, NULL);
+    pthread_join(g_consumer, NULL);
+}
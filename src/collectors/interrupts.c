@@ -0,0 +1,564 @@
+#define _DEFAULT_SOURCE
+#include "collectors/interrupts.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * /proc/interrupts is hundreds of rows x one column per CPU, almost all of it
+ * padding spaces and decimal counters. Two row scanners: plain byte loops,
+ * and one that classifies 16 bytes at a time (SSE2 / NEON, little-endian
+ * only) and decodes each digit run with a SWAR multiply sequence.
+ * interrupts_benchmark() times both on the same file and checks they agree.
+ * On bench/proc_interrupts_128cpu.txt the vector scanner wins by 20-35% with
+ * optimisation on and loses 35-45% without it (the intrinsics stay calls), so
+ * the sampler only uses it in optimised builds.
+ */
+#if (defined(__SSE2__) || defined(__ARM_NEON)) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define IRQ_SIMD 1
+#else
+#define IRQ_SIMD 0
+#endif
+
+#if IRQ_SIMD && defined(__SSE2__)
+#include <emmintrin.h>
+#elif IRQ_SIMD
+#include <arm_neon.h>
+#endif
+
+/* =======================
+ * Internal structures
+ * ======================= */
+
+#define IRQ_PAD 32      // zero bytes after the data: scanners stop on them, 16-byte loads stay inside
+#define BENCH_PARSES 200
+#define BENCH_ROUNDS 5
+
+// counters of one row after its "label:", the rest of the row zeroed; returns where they end
+typedef const char* (*ScanRow)(const char* q, unsigned long long* row, size_t cols);
+
+typedef struct {
+    const char* path;
+    int    fd;
+    char*  buf;
+    size_t buf_cap;
+
+    size_t rows, cols;
+    size_t row_cap;
+    char (*names)[IRQ_NAME_MAX];
+    unsigned char* numeric;         // label is a device IRQ number
+    unsigned char* has_prev;
+    unsigned long long* counts;     // row_cap x cols
+    unsigned long long* prev;
+    double* rates;
+    double* cpu_sum;                // cols, scratch for per-CPU totals
+
+    double last_s;
+} IrqMatrix;
+
+static IrqMatrix g_mat[IRQ_SRC_COUNT] = {
+    { .path = "/proc/interrupts", .fd = -1 },
+    { .path = "/proc/softirqs",   .fd = -1 },
+};
+
+/* =======================
+ * Helpers
+ * ======================= */
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static const char* skip_spaces(const char* p) {
+    while (*p == ' ') p++;
+    return p;
+}
+
+static const char* parse_counter(const char* p, unsigned long long* out) {
+    unsigned long long v = 0;
+    while (*p >= '0' && *p <= '9') v = v * 10u + (unsigned long long)(*p++ - '0');
+    *out = v;
+    return p;
+}
+
+static const char* scan_row_scalar(const char* q, unsigned long long* row, size_t cols) {
+    size_t c = 0;
+    for (; c < cols; c++) {
+        q = skip_spaces(q);
+        if (*q < '0' || *q > '9') break;    // ERR/MIS have a single column
+        q = parse_counter(q, &row[c]);
+    }
+    for (; c < cols; c++) row[c] = 0;
+    return q;
+}
+
+#if IRQ_SIMD
+
+#if defined(__SSE2__)
+static unsigned space_mask(const char* p) {
+    __m128i v = _mm_loadu_si128((const __m128i*)(const void*)p);
+    return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')));
+}
+
+static unsigned digit_mask(const char* p) {
+    __m128i v  = _mm_loadu_si128((const __m128i*)(const void*)p);
+    __m128i ge = _mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1));
+    __m128i le = _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1));
+    return (unsigned)_mm_movemask_epi8(_mm_and_si128(ge, le));
+}
+#else
+// pairwise adds instead of vaddv so 32-bit Raspberry Pi OS (ARMv7 NEON) builds too
+static unsigned neon_sum8(uint8x8_t v) {
+    return (unsigned)vget_lane_u64(vpaddl_u32(vpaddl_u16(vpaddl_u8(v))), 0);
+}
+
+// NEON has no movemask; narrow each 0x00/0xFF byte to one bit
+static unsigned neon_movemask(uint8x16_t m) {
+    static const uint8_t bits[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t b = vandq_u8(m, vld1q_u8(bits));
+    return neon_sum8(vget_low_u8(b)) | (neon_sum8(vget_high_u8(b)) << 8);
+}
+
+static unsigned space_mask(const char* p) {
+    uint8x16_t v = vld1q_u8((const uint8_t*)p);
+    return neon_movemask(vceqq_u8(v, vdupq_n_u8(' ')));
+}
+
+static unsigned digit_mask(const char* p) {
+    uint8x16_t v = vld1q_u8((const uint8_t*)p);
+    return neon_movemask(vcleq_u8(vsubq_u8(v, vdupq_n_u8('0')), vdupq_n_u8(9)));
+}
+#endif
+
+// n in 1..8 leading digits at p; bytes after them are discarded by the shift
+static uint64_t swar_digits(const char* p, size_t n) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    v -= 0x3030303030303030ULL;
+    v <<= 8 * (8 - n);  // most significant digits up, zero digits fill in below
+
+    v = (v * 10) + (v >> 8);
+    v = (((v & 0x000000FF000000FFULL) * 0x000F424000000064ULL) +
+         (((v >> 16) & 0x000000FF000000FFULL) * 0x0000271000000001ULL)) >> 32;
+    return v;
+}
+
+static const char* parse_counter_simd(const char* p, unsigned long long* out) {
+    unsigned not_digit = digit_mask(p) ^ 0xFFFFu;
+    size_t n = not_digit ? (size_t)__builtin_ctz(not_digit) : 16;
+
+    unsigned long long v;
+    if (n <= 8) {
+        v = n ? swar_digits(p, n) : 0;
+    } else {
+        v = swar_digits(p, n - 8) * 100000000ULL + swar_digits(p + (n - 8), 8);
+    }
+    p += n;
+
+    // more than 16 digits does not happen for 64-bit counters in practice, finish scalar
+    while (*p >= '0' && *p <= '9') v = v * 10u + (unsigned long long)(*p++ - '0');
+
+    *out = v;
+    return p;
+}
+
+/*
+ * One 16-byte block at a time: space and digit masks once per block, then
+ * every digit run that starts and ends inside it is decoded straight from
+ * the masks. A run crossing the block edge restarts the next block on it.
+ */
+static const char* scan_row_simd(const char* q, unsigned long long* row, size_t cols) {
+    size_t c = 0;
+    while (c < cols) {
+        unsigned digits = digit_mask(q);
+        unsigned stop = (digits | space_mask(q)) ^ 0xFFFFu;    // label text, newline, NUL
+        unsigned limit = stop ? (unsigned)__builtin_ctz(stop) : 16;
+        unsigned todo = digits & ((1u << limit) - 1);
+        unsigned next = limit;
+
+        while (todo) {
+            unsigned start = (unsigned)__builtin_ctz(todo);
+            unsigned run = (unsigned)__builtin_ctz(~(digits >> start));
+            if (start + run >= 16) {
+                if (start > 0) { next = start; break; }
+                // 16+ digits: only a 64-bit counter gets there
+                q = parse_counter_simd(q, &row[c++]);
+                next = 0;
+                break;
+            }
+            row[c++] = run == 1 ? (unsigned long long)(q[start] - '0')
+                     : run <= 8 ? swar_digits(q + start, run)
+                     : swar_digits(q + start, run - 8) * 100000000ULL + swar_digits(q + start + run - 8, 8);
+            if (c == cols) return q + start + run;
+            todo &= ~0u << (start + run);
+        }
+
+        if (stop && next == limit) { q += limit; break; }
+        q += next;
+    }
+    for (; c < cols; c++) row[c] = 0;
+    return q;
+}
+
+#endif
+
+static const struct {
+    const char* name;
+    ScanRow     scan;
+} g_scanners[] = {
+    { "scalar", scan_row_scalar },
+#if IRQ_SIMD
+    { "simd",   scan_row_simd },
+#endif
+};
+
+#define SCANNER_COUNT (sizeof(g_scanners) / sizeof(g_scanners[0]))
+
+// what the sampler uses
+#if IRQ_SIMD && defined(__OPTIMIZE__)
+static const ScanRow g_scan_row = scan_row_simd;
+#else
+static const ScanRow g_scan_row = scan_row_scalar;
+#endif
+
+static ssize_t read_file(IrqMatrix* m) {
+    if (m->fd < 0) {
+        m->fd = open(m->path, O_RDONLY | O_CLOEXEC);
+        if (m->fd < 0) return -1;
+    }
+
+    if (!m->buf) {
+        m->buf_cap = 65536;
+        m->buf = malloc(m->buf_cap);
+        if (!m->buf) return -1;
+    }
+
+    for (;;) {
+        size_t room = m->buf_cap - IRQ_PAD;
+        size_t len = 0;
+        for (;;) {
+            ssize_t r = pread(m->fd, m->buf + len, room - len, (off_t)len);
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            if (r == 0 || (len += (size_t)r) == room) break;
+        }
+
+        if (len < room) {
+            memset(m->buf + len, 0, IRQ_PAD);
+            return (ssize_t)len;
+        }
+
+        char* bigger = realloc(m->buf, m->buf_cap * 2);
+        if (!bigger) return -1;
+        m->buf = bigger;
+        m->buf_cap *= 2;
+    }
+}
+
+static void matrix_free(IrqMatrix* m) {
+    free(m->names);
+    free(m->numeric);
+    free(m->has_prev);
+    free(m->counts);
+    free(m->prev);
+    free(m->rates);
+    free(m->cpu_sum);
+    m->cpu_sum = NULL;
+    m->names = NULL;
+    m->numeric = m->has_prev = NULL;
+    m->counts = m->prev = NULL;
+    m->rates = NULL;
+    m->rows = m->row_cap = m->cols = 0;
+}
+
+// grows row capacity (keeping contents); only happens when IRQ lines are added
+static int matrix_reserve(IrqMatrix* m, size_t rows) {
+    if (rows <= m->row_cap) return 0;
+
+    size_t cap = m->row_cap ? m->row_cap * 2 : 64;
+    while (cap < rows) cap *= 2;
+    size_t cells = cap * m->cols;
+
+    void* names = realloc(m->names, cap * sizeof(*m->names));
+    if (!names) return -1;
+    m->names = names;
+
+    unsigned char* numeric = realloc(m->numeric, cap);
+    if (!numeric) return -1;
+    m->numeric = numeric;
+
+    unsigned char* has_prev = realloc(m->has_prev, cap);
+    if (!has_prev) return -1;
+    m->has_prev = has_prev;
+
+    unsigned long long* counts = realloc(m->counts, cells * sizeof(*counts));
+    if (!counts) return -1;
+    m->counts = counts;
+
+    unsigned long long* prev = realloc(m->prev, cells * sizeof(*prev));
+    if (!prev) return -1;
+    m->prev = prev;
+
+    double* rates = realloc(m->rates, cells * sizeof(*rates));
+    if (!rates) return -1;
+    m->rates = rates;
+
+    memset(m->has_prev + m->row_cap, 0, cap - m->row_cap);
+    memset(m->names + m->row_cap, 0, (cap - m->row_cap) * sizeof(*m->names));
+    m->row_cap = cap;
+    return 0;
+}
+
+// device IRQ rows end with the driver name; use it instead of the bare number
+static void row_name(char out[IRQ_NAME_MAX], const char* label, size_t label_len,
+                     const char* desc, const char* eol, int numeric) {
+    const char* end = eol;
+    while (end > desc && (end[-1] == ' ' || end[-1] == '\r')) end--;
+    const char* start = end;
+    while (start > desc && start[-1] != ' ') start--;
+
+    if (!numeric || start == end) { start = label; end = label + label_len; }
+
+    size_t n = (size_t)(end - start);
+    if (n >= IRQ_NAME_MAX) n = IRQ_NAME_MAX - 1;
+    memcpy(out, start, n);
+    out[n] = '\0';
+}
+
+// the file already in m->buf; dt 0 = no rates yet
+static int parse_buffer(IrqMatrix* m, ScanRow scan_row, double dt) {
+    // header: one "CPUn" per online CPU
+    const char* p = m->buf;
+    const char* eol = strchr(p, '\n');
+    if (!eol) return -1;
+
+    size_t cols = 0;
+    for (const char* q = p; (q = strstr(q, "CPU")) != NULL && q < eol; q += 3) cols++;
+    if (cols == 0) return -1;
+
+    if (cols != m->cols) {
+        matrix_free(m); // CPU hotplug: start over
+        m->cols = cols;
+        m->cpu_sum = calloc(cols, sizeof(*m->cpu_sum));
+        if (!m->cpu_sum) { m->cols = 0; return -1; }
+    }
+
+    // previous tick's counts become the baseline
+    unsigned long long* tmp = m->prev;
+    m->prev = m->counts;
+    m->counts = tmp;
+
+    size_t rows_before = m->rows;
+    size_t r = 0;
+    p = eol + 1;
+
+    while (*p) {
+        const char* label = skip_spaces(p);
+        const char* colon = label;
+        while (*colon && *colon != ':' && *colon != '\n') colon++;
+        if (*colon != ':') break;
+
+        if (matrix_reserve(m, r + 1) != 0) return -1;
+
+        unsigned long long* row = &m->counts[r * cols];
+        const char* q = scan_row(colon + 1, row, cols);
+
+        eol = strchr(q, '\n');
+        if (!eol) eol = q + strlen(q);
+
+        char name[IRQ_NAME_MAX];
+        int numeric = (label[0] >= '0' && label[0] <= '9');
+        row_name(name, label, (size_t)(colon - label), q, eol, numeric);
+
+        // same position but a different line (IRQ registered/freed): no baseline for it
+        if (r >= rows_before || strcmp(name, m->names[r]) != 0) {
+            memcpy(m->names[r], name, sizeof(name));
+            m->has_prev[r] = 0;
+        }
+        m->numeric[r] = (unsigned char)numeric;
+
+        double* rate = &m->rates[r * cols];
+        const unsigned long long* before = &m->prev[r * cols];
+        for (size_t c = 0; c < cols; c++) {
+            rate[c] = (m->has_prev[r] && dt > 0.0 && row[c] >= before[c])
+                    ? (double)(row[c] - before[c]) / dt : 0.0;
+        }
+        m->has_prev[r] = 1;
+
+        r++;
+        p = *eol ? eol + 1 : eol;
+    }
+
+    for (size_t k = r; k < rows_before; k++) m->has_prev[k] = 0;
+    m->rows = r;
+    return 0;
+}
+
+static int parse_matrix(IrqMatrix* m) {
+    if (read_file(m) < 0) return -1;
+
+    double t  = now_s();
+    double dt = (m->last_s > 0.0) ? t - m->last_s : 0.0;
+    m->last_s = t;
+
+    return parse_buffer(m, g_scan_row, dt);
+}
+
+static double imbalance(const double* per_cpu, size_t cols) {
+    double sum = 0.0, max = 0.0;
+    for (size_t c = 0; c < cols; c++) {
+        sum += per_cpu[c];
+        if (per_cpu[c] > max) max = per_cpu[c];
+    }
+    if (sum <= 0.0) return 1.0;
+    return max / (sum / (double)cols);
+}
+
+/* =======================
+ * Public API
+ * ======================= */
+
+int interrupts_sample(IrqSummary* out) {
+    if (!out) return -1;
+    memset(out, 0, sizeof(*out));
+    out->hottest_irq_cpu = -1;
+    out->irq_imbalance = out->net_rx_imbalance = 1.0;
+
+    IrqMatrix* hard = &g_mat[IRQ_SRC_HARD];
+    IrqMatrix* soft = &g_mat[IRQ_SRC_SOFT];
+    int ok_hard = parse_matrix(hard) == 0;
+    int ok_soft = parse_matrix(soft) == 0;
+    if (!ok_hard && !ok_soft) return -1;
+
+    if (ok_hard) {
+        double* per_cpu = hard->cpu_sum;
+        memset(per_cpu, 0, hard->cols * sizeof(*per_cpu));
+
+        for (size_t r = 0; r < hard->rows; r++) {
+            const double* rate = &hard->rates[r * hard->cols];
+            double row_sum = 0.0;
+            size_t row_max_cpu = 0;
+            for (size_t c = 0; c < hard->cols; c++) {
+                row_sum += rate[c];
+                if (rate[c] > rate[row_max_cpu]) row_max_cpu = c;
+                if (hard->numeric[r]) per_cpu[c] += rate[c];
+            }
+            out->irq_total_per_s += row_sum;
+
+            if (hard->numeric[r] && row_sum > out->hottest_irq_per_s) {
+                out->hottest_irq_per_s = row_sum;
+                out->hottest_irq_cpu = (int)row_max_cpu;
+                memcpy(out->hottest_irq, hard->names[r], IRQ_NAME_MAX);
+            }
+        }
+        out->irq_imbalance = imbalance(per_cpu, hard->cols);
+    }
+
+    if (ok_soft) {
+        for (size_t r = 0; r < soft->rows; r++) {
+            const double* rate = &soft->rates[r * soft->cols];
+            double row_sum = 0.0;
+            for (size_t c = 0; c < soft->cols; c++) row_sum += rate[c];
+            out->softirq_total_per_s += row_sum;
+
+            if (strcmp(soft->names[r], "NET_RX") == 0) {
+                out->net_rx_softirq_per_s = row_sum;
+                out->net_rx_imbalance = imbalance(rate, soft->cols);
+            }
+        }
+    }
+
+    return 0;
+}
+
+int interrupts_rates(IrqSource src, const double** rates, const char (**names)[IRQ_NAME_MAX],
+                     size_t* rows, size_t* cols) {
+    if (src < 0 || src >= IRQ_SRC_COUNT) return -1;
+    const IrqMatrix* m = &g_mat[src];
+    if (m->rows == 0) return -1;
+
+    if (rates) *rates = m->rates;
+    if (names) *names = (const char (*)[IRQ_NAME_MAX])m->names;
+    if (rows)  *rows = m->rows;
+    if (cols)  *cols = m->cols;
+    return 0;
+}
+
+void interrupts_deinit(void) {
+    for (int i = 0; i < IRQ_SRC_COUNT; i++) {
+        IrqMatrix* m = &g_mat[i];
+        if (m->fd >= 0) close(m->fd);
+        m->fd = -1;
+        free(m->buf);
+        m->buf = NULL;
+        m->buf_cap = 0;
+        matrix_free(m);
+        m->last_s = 0.0;
+    }
+}
+
+int interrupts_benchmark(const char* path) {
+    IrqMatrix m[SCANNER_COUNT];
+    memset(m, 0, sizeof(m));
+    int rc = 0;
+
+    for (size_t i = 0; i < SCANNER_COUNT; i++) {
+        m[i].path = path;
+        m[i].fd = -1;
+        if (read_file(&m[i]) < 0 || parse_buffer(&m[i], g_scanners[i].scan, 0.0) != 0) {
+            fprintf(stderr, "irq bench: cannot parse %s\n", path);
+            rc = 1;
+            goto out;
+        }
+    }
+
+    // same matrix from every scanner first, or the timing means nothing
+    size_t diffs = 0;
+    for (size_t i = 1; i < SCANNER_COUNT; i++) {
+        if (m[i].rows != m[0].rows || m[i].cols != m[0].cols) {
+            diffs++;
+            continue;
+        }
+        for (size_t r = 0; r < m[0].rows; r++) {
+            diffs += strcmp(m[i].names[r], m[0].names[r]) != 0 || m[i].numeric[r] != m[0].numeric[r];
+            for (size_t c = 0; c < m[0].cols; c++)
+                diffs += m[i].counts[r * m[0].cols + c] != m[0].counts[r * m[0].cols + c];
+        }
+    }
+
+    double best[SCANNER_COUNT] = { 0.0 };
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (size_t i = 0; i < SCANNER_COUNT; i++) {
+            double t = now_s();
+            for (int k = 0; k < BENCH_PARSES; k++) parse_buffer(&m[i], g_scanners[i].scan, 1.0);
+            double us = (now_s() - t) * 1e6 / BENCH_PARSES;
+            if (round == 0 || us < best[i]) best[i] = us;
+        }
+    }
+
+    printf("irq bench: %s, %zu rows x %zu CPUs, %d parses x %d rounds, best round\n",
+           path, m[0].rows, m[0].cols, BENCH_PARSES, BENCH_ROUNDS);
+    for (size_t i = 0; i < SCANNER_COUNT; i++)
+        printf("  %-8s %8.1f us/parse  (%.2fx)\n", g_scanners[i].name, best[i], best[0] / best[i]);
+    if (SCANNER_COUNT == 1) printf("  simd     not built for this target\n");
+    printf("  matrices %s (%zu cells differ)\n", diffs ? "DIFFER" : "identical", diffs);
+    rc = diffs != 0;
+
+out:
+    for (size_t i = 0; i < SCANNER_COUNT; i++) {
+        if (m[i].fd >= 0) close(m[i].fd);
+        free(m[i].buf);
+        matrix_free(&m[i]);
+    }
+    return rc;
+}
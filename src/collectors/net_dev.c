@@ -0,0 +1,274 @@
+#define _DEFAULT_SOURCE
+#include "collectors/net_dev.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* =======================
+ * Internal structures
+ * ======================= */
+
+// open addressing, linear probing. Kept at most half full so probes stay short
+// even with hundreds of veth pairs coming and going.
+#define NET_TABLE_SIZE  2048u
+#define NET_MAX_IFACES  (NET_TABLE_SIZE / 2)
+
+enum {
+    C_RX_BYTES = 0, C_RX_PACKETS, C_RX_ERRS, C_RX_DROP,
+    C_TX_BYTES, C_TX_PACKETS, C_TX_ERRS, C_TX_DROP,
+    C_COUNT
+};
+
+typedef struct {
+    int used;
+    int has_prev;
+    uint32_t hash;
+    uint32_t seen_gen;
+    char name[NET_IFNAME_MAX];
+    unsigned long long counters[C_COUNT];
+    NetIfRates rates;
+} NetEntry;
+
+static NetEntry g_table[NET_TABLE_SIZE];
+static size_t   g_count = 0;
+static uint32_t g_gen   = 0;
+
+static int    g_fd       = -1;
+static char*  g_buf      = NULL;
+static size_t g_buf_cap  = 0;
+static double g_last_s   = 0.0;
+
+/* =======================
+ * Helpers
+ * ======================= */
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint32_t hash_name(const char* s, size_t n) {
+    uint32_t h = 2166136261u; // FNV-1a
+    for (size_t i = 0; i < n; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static NetEntry* find_or_insert(const char* name, size_t n) {
+    uint32_t h = hash_name(name, n);
+    size_t i = h & (NET_TABLE_SIZE - 1);
+
+    for (;;) {
+        NetEntry* e = &g_table[i];
+        if (!e->used) break;
+        if (e->hash == h && memcmp(e->name, name, n) == 0 && e->name[n] == '\0')
+            return e;
+        i = (i + 1) & (NET_TABLE_SIZE - 1);
+    }
+
+    if (g_count >= NET_MAX_IFACES) return NULL;
+
+    NetEntry* e = &g_table[i];
+    memset(e, 0, sizeof(*e));
+    e->used = 1;
+    e->hash = h;
+    memcpy(e->name, name, n);
+    e->name[n] = '\0';
+    memcpy(e->rates.name, e->name, n + 1);
+    g_count++;
+    return e;
+}
+
+// backward-shift deletion keeps probe chains intact without tombstones
+static void remove_at(size_t i) {
+    size_t j = i;
+    for (;;) {
+        j = (j + 1) & (NET_TABLE_SIZE - 1);
+        if (!g_table[j].used) break;
+
+        size_t home = g_table[j].hash & (NET_TABLE_SIZE - 1);
+        // move j into the hole at i only if its home is not in (i, j]
+        int between = (i <= j) ? (home > i && home <= j) : (home > i || home <= j);
+        if (between) continue;
+
+        g_table[i] = g_table[j];
+        i = j;
+    }
+    g_table[i].used = 0;
+    g_count--;
+}
+
+static void evict_unseen(void) {
+    size_t i = 0;
+    while (i < NET_TABLE_SIZE) {
+        if (g_table[i].used && g_table[i].seen_gen != g_gen) {
+            remove_at(i); // slot i may now hold a shifted entry, re-check it
+            continue;
+        }
+        i++;
+    }
+}
+
+// whole file in one buffer; buffer only grows, so steady state does not allocate
+static ssize_t read_whole(void) {
+    if (g_fd < 0) {
+        g_fd = open("/proc/net/dev", O_RDONLY | O_CLOEXEC);
+        if (g_fd < 0) return -1;
+    }
+
+    if (!g_buf) {
+        g_buf_cap = 16384;
+        g_buf = malloc(g_buf_cap);
+        if (!g_buf) return -1;
+    }
+
+    for (;;) {
+        size_t len = 0;
+        for (;;) {
+            ssize_t r = pread(g_fd, g_buf + len, g_buf_cap - 1 - len, (off_t)len);
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            if (r == 0) break;
+            len += (size_t)r;
+            if (len == g_buf_cap - 1) break;
+        }
+
+        if (len < g_buf_cap - 1) {
+            g_buf[len] = '\0';
+            return (ssize_t)len;
+        }
+
+        char* bigger = realloc(g_buf, g_buf_cap * 2);
+        if (!bigger) return -1;
+        g_buf = bigger;
+        g_buf_cap *= 2;
+    }
+}
+
+static const char* parse_u64(const char* p, unsigned long long* out) {
+    while (*p == ' ') p++;
+    unsigned long long v = 0;
+    while (*p >= '0' && *p <= '9') {
+        v = v * 10u + (unsigned long long)(*p - '0');
+        p++;
+    }
+    *out = v;
+    return p;
+}
+
+static double rate(unsigned long long cur, unsigned long long prev, double dt) {
+    if (cur < prev || dt <= 0.0) return 0.0; // counter reset
+    return (double)(cur - prev) / dt;
+}
+
+/* =======================
+ * Public API
+ * ======================= */
+
+int net_dev_sample(NetIfRates* top_out, size_t* count_out) {
+    if (read_whole() < 0) return -1;
+
+    double t  = now_s();
+    double dt = (g_last_s > 0.0) ? t - g_last_s : 0.0;
+    g_last_s  = t;
+    g_gen++;
+
+    // skip the two header lines
+    const char* p = g_buf;
+    for (int skip = 0; skip < 2 && p; skip++) {
+        p = strchr(p, '\n');
+        if (p) p++;
+    }
+
+    while (p && *p) {
+        while (*p == ' ') p++;
+        const char* name = p;
+        const char* colon = p;
+        while (*colon && *colon != ':' && *colon != '\n') colon++;
+        if (*colon != ':') break;
+
+        size_t n = (size_t)(colon - name);
+        if (n >= NET_IFNAME_MAX) n = NET_IFNAME_MAX - 1;
+
+        unsigned long long f[16];
+        const char* q = colon + 1;
+        for (int k = 0; k < 16; k++) q = parse_u64(q, &f[k]);
+
+        NetEntry* e = find_or_insert(name, n);
+        if (e) {
+            // rx: bytes packets errs drop fifo frame compressed multicast, tx: bytes packets errs drop ...
+            unsigned long long cur[C_COUNT] = { f[0], f[1], f[2], f[3], f[8], f[9], f[10], f[11] };
+            int has_baseline = e->has_prev && dt > 0.0; // new interfaces start without a delta
+
+            NetIfRates* r = &e->rates;
+            r->rx_bytes_per_s   = has_baseline ? rate(cur[C_RX_BYTES],   e->counters[C_RX_BYTES],   dt) : 0.0;
+            r->rx_packets_per_s = has_baseline ? rate(cur[C_RX_PACKETS], e->counters[C_RX_PACKETS], dt) : 0.0;
+            r->rx_errs_per_s    = has_baseline ? rate(cur[C_RX_ERRS],    e->counters[C_RX_ERRS],    dt) : 0.0;
+            r->rx_drop_per_s    = has_baseline ? rate(cur[C_RX_DROP],    e->counters[C_RX_DROP],    dt) : 0.0;
+            r->tx_bytes_per_s   = has_baseline ? rate(cur[C_TX_BYTES],   e->counters[C_TX_BYTES],   dt) : 0.0;
+            r->tx_packets_per_s = has_baseline ? rate(cur[C_TX_PACKETS], e->counters[C_TX_PACKETS], dt) : 0.0;
+            r->tx_errs_per_s    = has_baseline ? rate(cur[C_TX_ERRS],    e->counters[C_TX_ERRS],    dt) : 0.0;
+            r->tx_drop_per_s    = has_baseline ? rate(cur[C_TX_DROP],    e->counters[C_TX_DROP],    dt) : 0.0;
+
+            memcpy(e->counters, cur, sizeof(cur));
+            e->has_prev = 1;
+            e->seen_gen = g_gen;
+        }
+
+        p = strchr(q, '\n');
+        if (p) p++;
+    }
+
+    evict_unseen();
+
+    if (top_out) {
+        const NetEntry* best = NULL;
+        double best_bytes = -1.0;
+        for (size_t i = 0; i < NET_TABLE_SIZE; i++) {
+            const NetEntry* e = &g_table[i];
+            if (!e->used || strcmp(e->name, "lo") == 0) continue;
+            double bytes = e->rates.rx_bytes_per_s + e->rates.tx_bytes_per_s;
+            // ties (e.g. all idle) resolve to the alphabetically first name so the page is stable
+            if (bytes > best_bytes || (bytes == best_bytes && strcmp(e->name, best->name) < 0)) {
+                best = e;
+                best_bytes = bytes;
+            }
+        }
+
+        if (best) *top_out = best->rates;
+        else memset(top_out, 0, sizeof(*top_out));
+    }
+
+    if (count_out) *count_out = g_count;
+    return 0;
+}
+
+size_t net_dev_snapshot(NetIfRates* out, size_t max) {
+    if (!out) return 0;
+    size_t n = 0;
+    for (size_t i = 0; i < NET_TABLE_SIZE && n < max; i++) {
+        if (g_table[i].used) out[n++] = g_table[i].rates;
+    }
+    return n;
+}
+
+void net_dev_deinit(void) {
+    if (g_fd >= 0) close(g_fd);
+    g_fd = -1;
+    free(g_buf);
+    g_buf = NULL;
+    g_buf_cap = 0;
+    memset(g_table, 0, sizeof(g_table));
+    g_count = 0;
+    g_last_s = 0.0;
+}
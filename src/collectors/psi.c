@@ -0,0 +1,174 @@
+#define _DEFAULT_SOURCE
+#include "collectors/psi.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static const char* const g_paths[PSI_COUNT] = {
+    "/proc/pressure/cpu",
+    "/proc/pressure/memory",
+    "/proc/pressure/io",
+};
+
+static int g_read_fd[PSI_COUNT]    = { -1, -1, -1 };
+static int g_trigger_fd[PSI_COUNT] = { -1, -1, -1 };
+static int g_read_tried = 0;
+
+/* =======================
+ * Helpers
+ * ======================= */
+
+static void sleep_ms(int ms) {
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+}
+
+static int parse_resource(int fd, PsiResource* r) {
+    char buf[256];
+    ssize_t n = pread(fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) return -1;
+    buf[n] = '\0';
+
+    memset(r, 0, sizeof(*r));
+
+    // "some avg10=0.00 avg60=0.00 avg300=0.00 total=0\nfull ..."
+    char* line = buf;
+    while (line && *line) {
+        double a10, a60, a300;
+        unsigned long long total;
+        char kind[5];
+
+        if (sscanf(line, "%4s avg10=%lf avg60=%lf avg300=%lf total=%llu", kind, &a10, &a60, &a300, &total) == 5) {
+            if (strcmp(kind, "some") == 0) {
+                r->some_avg10 = a10; r->some_avg60 = a60; r->some_avg300 = a300;
+                r->some_total_us = total;
+                r->available = 1;
+            } else if (strcmp(kind, "full") == 0) {
+                r->full_avg10 = a10; r->full_avg60 = a60; r->full_avg300 = a300;
+                r->full_total_us = total;
+            }
+        }
+
+        line = strchr(line, '\n');
+        if (line) line++;
+    }
+
+    return r->available ? 0 : -1;
+}
+
+static int register_trigger(int kind, unsigned threshold_us, unsigned window_us) {
+    int fd = open(g_paths[kind], O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    char spec[64];
+    int len = snprintf(spec, sizeof(spec), "some %u %u", threshold_us, window_us);
+
+    // the kernel wants the terminating NUL as part of the write
+    if (write(fd, spec, (size_t)len + 1) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/* =======================
+ * Public API
+ * ======================= */
+
+int psi_read_all(PsiResource out[PSI_COUNT]) {
+    if (!out) return -1;
+
+    if (!g_read_tried) {
+        g_read_tried = 1;
+        for (int i = 0; i < PSI_COUNT; i++) g_read_fd[i] = open(g_paths[i], O_RDONLY | O_CLOEXEC);
+    }
+
+    int ok = 0;
+    for (int i = 0; i < PSI_COUNT; i++) {
+        if (g_read_fd[i] < 0 || parse_resource(g_read_fd[i], &out[i]) != 0) {
+            memset(&out[i], 0, sizeof(out[i]));
+            continue;
+        }
+        ok++;
+    }
+
+    return ok > 0 ? 0 : -1;
+}
+
+int psi_triggers_init(unsigned threshold_us, unsigned window_us) {
+    int registered = 0;
+
+    for (int i = 0; i < PSI_COUNT; i++) {
+        if (g_trigger_fd[i] >= 0) { registered++; continue; }
+
+        int fd = register_trigger(i, threshold_us, window_us);
+
+        // unprivileged triggers need a window that is a multiple of 2 s; keep the same stall ratio
+        if (fd < 0 && (errno == EPERM || errno == EACCES || errno == EINVAL) && window_us < 2000000u) {
+            unsigned scale = 2000000u / (window_us ? window_us : 1u);
+            fd = register_trigger(i, threshold_us * scale, 2000000u);
+        }
+
+        if (fd >= 0) {
+            g_trigger_fd[i] = fd;
+            registered++;
+        }
+    }
+
+    return registered;
+}
+
+int psi_triggers_wait(int timeout_ms) {
+    struct pollfd pfd[PSI_COUNT];
+    int kind[PSI_COUNT];
+    nfds_t n = 0;
+
+    for (int i = 0; i < PSI_COUNT; i++) {
+        if (g_trigger_fd[i] < 0) continue;
+        kind[n] = i;
+        pfd[n].fd = g_trigger_fd[i];
+        pfd[n].events = POLLPRI;
+        pfd[n].revents = 0;
+        n++;
+    }
+
+    if (n == 0) {
+        sleep_ms(timeout_ms);
+        return 0;
+    }
+
+    int r = poll(pfd, n, timeout_ms);
+    if (r < 0) return (errno == EINTR) ? 0 : -1;
+    if (r == 0) return 0;
+
+    int stalled = 0;
+    for (nfds_t i = 0; i < n; i++) {
+        if (pfd[i].revents & POLLERR) {
+            // trigger is dead; drop it so the caller does not spin on it
+            close(g_trigger_fd[kind[i]]);
+            g_trigger_fd[kind[i]] = -1;
+            continue;
+        }
+        if (pfd[i].revents & POLLPRI) stalled = 1;
+    }
+
+    return stalled;
+}
+
+void psi_deinit(void) {
+    for (int i = 0; i < PSI_COUNT; i++) {
+        if (g_read_fd[i] >= 0) close(g_read_fd[i]);
+        if (g_trigger_fd[i] >= 0) close(g_trigger_fd[i]);
+        g_read_fd[i] = -1;
+        g_trigger_fd[i] = -1;
+    }
+    g_read_tried = 0;
+}
@@ -0,0 +1,94 @@
+#define _GNU_SOURCE
+#include "diag/perf_counters.h"
+
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+enum { PC_CYCLES = 0, PC_INSTRUCTIONS, PC_CTX_SWITCHES, PC_COUNT };
+
+static int        g_fd[PC_COUNT] = { -1, -1, -1 };
+static uint64_t   g_start[PC_COUNT];
+static PerfTotals g_totals;
+
+static int open_counter(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    // pid 0 / cpu -1: this thread on any CPU; user space only, so allowed unprivileged at paranoid 2
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+}
+
+static uint64_t read_counter(int fd) {
+    uint64_t v = 0;
+    if (fd < 0 || read(fd, &v, sizeof(v)) != (ssize_t)sizeof(v)) return 0;
+    return v;
+}
+
+/*
+ * The perf software counter for context switches counts in the kernel and
+ * needs perf_event_paranoid <= 1 or CAP_PERFMON; getrusage() has the same
+ * number for the calling thread with no privileges at all.
+ */
+static uint64_t read_ctx_switches(void) {
+    struct rusage ru;
+    if (getrusage(RUSAGE_THREAD, &ru) != 0) return 0;
+    return (uint64_t)ru.ru_nvcsw + (uint64_t)ru.ru_nivcsw;
+}
+
+static uint64_t read_value(int i) {
+    return i == PC_CTX_SWITCHES ? read_ctx_switches() : read_counter(g_fd[i]);
+}
+
+int perf_counters_init(void) {
+    perf_counters_deinit();
+
+    g_fd[PC_CYCLES]       = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    g_fd[PC_INSTRUCTIONS] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+
+    struct rusage ru;
+    g_totals.have_cycles       = g_fd[PC_CYCLES] >= 0;
+    g_totals.have_instructions = g_fd[PC_INSTRUCTIONS] >= 0;
+    g_totals.have_ctx_switches = getrusage(RUSAGE_THREAD, &ru) == 0;
+
+    return g_totals.have_cycles + g_totals.have_instructions + g_totals.have_ctx_switches;
+}
+
+void perf_counters_begin(void) {
+    for (int i = 0; i < PC_COUNT; i++) g_start[i] = read_value(i);
+}
+
+void perf_counters_end(void) {
+    uint64_t d[PC_COUNT];
+    for (int i = 0; i < PC_COUNT; i++) {
+        uint64_t now = read_value(i);
+        d[i] = (now >= g_start[i]) ? now - g_start[i] : 0;
+    }
+
+    g_totals.windows++;
+    g_totals.last_cycles       = d[PC_CYCLES];
+    g_totals.last_instructions = d[PC_INSTRUCTIONS];
+    g_totals.last_ctx_switches = d[PC_CTX_SWITCHES];
+    g_totals.cycles       += d[PC_CYCLES];
+    g_totals.instructions += d[PC_INSTRUCTIONS];
+    g_totals.ctx_switches += d[PC_CTX_SWITCHES];
+}
+
+void perf_counters_totals(PerfTotals* out) {
+    if (out) *out = g_totals;
+}
+
+void perf_counters_deinit(void) {
+    for (int i = 0; i < PC_COUNT; i++) {
+        if (g_fd[i] >= 0) close(g_fd[i]);
+        g_fd[i] = -1;
+    }
+    memset(&g_totals, 0, sizeof(g_totals));
+}
@@ -0,0 +1,169 @@
+#define _DEFAULT_SOURCE
+#include "diag/self_stats.h"
+#include "diag/perf_counters.h"
+
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+
+/* =======================
+ * Internal structures
+ * ======================= */
+
+/*
+ * Log-linear buckets: values below 8 ns get their own bucket, above that
+ * every power of two is split into 8 linear sub-buckets (3 bits), so the
+ * relative error is at most 12.5% over the whole 64-bit range.
+ */
+#define DIAG_SUB_BITS   3
+#define DIAG_SUB_COUNT  (1u << DIAG_SUB_BITS)
+#define DIAG_BUCKETS    ((64 - DIAG_SUB_BITS + 1) * DIAG_SUB_COUNT)
+
+typedef struct {
+    uint32_t buckets[DIAG_BUCKETS];
+    uint64_t count;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+} DiagHistogram;
+
+static DiagHistogram g_hist[DIAG_STAGE_COUNT];
+
+static const char* const g_stage_names[DIAG_STAGE_COUNT] = {
+    [DIAG_SAMPLE]      = "sample",
+    [DIAG_CPU]         = "cpu",
+    [DIAG_MEMORY]      = "memory",
+    [DIAG_LOADAVG]     = "loadavg",
+    [DIAG_UPTIME]      = "uptime",
+    [DIAG_TEMP]        = "temp",
+    [DIAG_NET]         = "net",
+    [DIAG_PROCS]       = "procs",
+    [DIAG_PSI]         = "psi",
+    [DIAG_CGROUP]      = "cgroup",
+    [DIAG_IRQ]         = "irq",
+    [DIAG_ESTIMATORS]  = "estimators",
+    [DIAG_RULES]       = "rules",
+    [DIAG_PAGE_RENDER] = "page_render",
+    [DIAG_LCD_WRITE]   = "lcd_write",
+    [DIAG_LOOP]        = "loop",
+};
+
+static volatile sig_atomic_t g_dump_requested = 0;
+
+/* =======================
+ * Helpers
+ * ======================= */
+
+static unsigned bucket_of(uint64_t v) {
+    if (v < DIAG_SUB_COUNT) return (unsigned)v;
+    unsigned msb = 63u - (unsigned)__builtin_clzll(v);
+    unsigned sub = (unsigned)(v >> (msb - DIAG_SUB_BITS)) & (DIAG_SUB_COUNT - 1);
+    return ((msb - DIAG_SUB_BITS + 1) << DIAG_SUB_BITS) + sub;
+}
+
+// upper edge of a bucket, what percentiles report
+static uint64_t bucket_upper(unsigned b) {
+    if (b < DIAG_SUB_COUNT) return b;
+    unsigned msb = (b >> DIAG_SUB_BITS) + DIAG_SUB_BITS - 1;
+    uint64_t sub = b & (DIAG_SUB_COUNT - 1);
+    uint64_t lower = (1ULL << msb) | (sub << (msb - DIAG_SUB_BITS));
+    return lower + (1ULL << (msb - DIAG_SUB_BITS)) - 1;
+}
+
+static uint64_t percentile(const DiagHistogram* h, double q) {
+    if (h->count == 0) return 0;
+    uint64_t rank = (uint64_t)(q * (double)(h->count - 1)) + 1;
+    uint64_t seen = 0;
+    for (unsigned b = 0; b < DIAG_BUCKETS; b++) {
+        seen += h->buckets[b];
+        if (seen >= rank) {
+            uint64_t v = bucket_upper(b);
+            return v < h->max_ns ? v : h->max_ns;
+        }
+    }
+    return h->max_ns;
+}
+
+static void on_sigusr1(int sig) {
+    (void)sig;
+    g_dump_requested = 1;
+}
+
+/* =======================
+ * Public API
+ * ======================= */
+
+uint64_t diag_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void diag_record(DiagStage stage, uint64_t ns) {
+    DiagHistogram* h = &g_hist[stage];
+    h->buckets[bucket_of(ns)]++;
+    h->count++;
+    h->sum_ns += ns;
+    if (ns > h->max_ns) h->max_ns = ns;
+}
+
+uint64_t diag_lap(DiagStage stage, uint64_t since) {
+    uint64_t now = diag_now_ns();
+    diag_record(stage, now - since);
+    return now;
+}
+
+void diag_summary(DiagStage stage, DiagSummary* out) {
+    const DiagHistogram* h = &g_hist[stage];
+    out->count   = h->count;
+    out->p50_ns  = percentile(h, 0.50);
+    out->p99_ns  = percentile(h, 0.99);
+    out->max_ns  = h->max_ns;
+    out->mean_ns = h->count ? (double)h->sum_ns / (double)h->count : 0.0;
+}
+
+const char* diag_stage_name(DiagStage stage) {
+    if (stage < 0 || stage >= DIAG_STAGE_COUNT) return "?";
+    return g_stage_names[stage];
+}
+
+void diag_dump(FILE* f) {
+    fprintf(f, "%-12s %10s %10s %10s %10s %10s\n", "stage", "count", "mean_us", "p50_us", "p99_us", "max_us");
+
+    for (int i = 0; i < DIAG_STAGE_COUNT; i++) {
+        DiagSummary s;
+        diag_summary((DiagStage)i, &s);
+        if (s.count == 0) continue;
+        fprintf(f, "%-12s %10llu %10.1f %10.1f %10.1f %10.1f\n", g_stage_names[i], (unsigned long long)s.count,
+                s.mean_ns / 1e3, (double)s.p50_ns / 1e3, (double)s.p99_ns / 1e3, (double)s.max_ns / 1e3);
+    }
+
+    PerfTotals p;
+    perf_counters_totals(&p);
+    if (p.windows > 0 && (p.have_cycles || p.have_instructions || p.have_ctx_switches)) {
+        double w = (double)p.windows;
+        fprintf(f, "sampler/tick: ");
+        if (p.have_cycles)       fprintf(f, "cycles %.0f  ", (double)p.cycles / w);
+        if (p.have_instructions) fprintf(f, "instructions %.0f  ", (double)p.instructions / w);
+        if (p.have_cycles && p.have_instructions && p.cycles > 0)
+            fprintf(f, "ipc %.2f  ", (double)p.instructions / (double)p.cycles);
+        if (p.have_ctx_switches) fprintf(f, "ctx switches %.2f", (double)p.ctx_switches / w);
+        fprintf(f, "\n");
+    }
+    fflush(f);
+}
+
+void diag_install_sigusr1(void) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_sigusr1;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &sa, NULL);
+}
+
+int diag_poll_dump(FILE* f) {
+    if (!g_dump_requested) return 0;
+    g_dump_requested = 0;
+    diag_dump(f);
+    return 1;
+}
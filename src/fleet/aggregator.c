@@ -0,0 +1,391 @@
+#define _GNU_SOURCE
+#include "fleet/aggregator.h"
+
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+/* =======================
+ * Internal structures
+ * ======================= */
+
+#define RECV_BATCH      64                      // datagrams per recvmmsg()
+#define RECV_BUFFER     (4 * 1024 * 1024)       // SO_RCVBUF, absorbs bursts from hundreds of nodes
+#define HASH_SLOTS      (2 * FLEET_MAX_NODES)   // power of two, at most half full
+#define TICK_MS         100                     // stale sweep + publish
+
+typedef struct {
+    FleetSample last;
+    uint64_t    last_seen_ns;
+    int         fresh;                          // in the rankings
+    int         heap_pos[FLEET_RANK_COUNT];
+} Node;
+
+typedef struct {
+    int      item[FLEET_MAX_NODES];             // node indexes, max-heap on the rank's metric
+    unsigned size;
+} Heap;
+
+// everything below up to the view is owned by the receiver thread
+static Node     g_nodes[FLEET_MAX_NODES];
+static unsigned g_node_count = 0;
+static short    g_hash[HASH_SLOTS];             // node index, -1 empty
+static Heap     g_heap[FLEET_RANK_COUNT];
+
+static uint64_t g_received = 0, g_lost = 0, g_bad = 0;
+static uint64_t g_batches = 0;
+
+/*
+ * Seqlock: odd while the receiver rewrites g_view. Readers copy and retry
+ * if the sequence moved; the receiver never waits on them.
+ */
+static _Atomic unsigned g_view_seq = 0;
+static FleetView        g_view;
+
+static int        g_fd = -1;
+static uint16_t   g_port = 0;
+static pthread_t  g_thread;
+static atomic_int g_running = 0;
+
+/* =======================
+ * Helpers
+ * ======================= */
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static float rank_value(int node, FleetRank r) {
+    const FleetSample* s = &g_nodes[node].last;
+    switch (r) {
+        case FLEET_RANK_TEMP: return s->temp_c;
+        case FLEET_RANK_CORE: return s->busiest_core_percent;
+        case FLEET_RANK_CPU:  return s->cpu_percent;
+        case FLEET_RANK_MEM:  return s->mem_used_percent;
+        default:              return 0.0f;
+    }
+}
+
+static void heap_set(Heap* h, FleetRank r, unsigned pos, int node) {
+    h->item[pos] = node;
+    g_nodes[node].heap_pos[r] = (int)pos;
+}
+
+static void sift_up(Heap* h, FleetRank r, unsigned pos) {
+    int node = h->item[pos];
+    float v = rank_value(node, r);
+    while (pos > 0) {
+        unsigned parent = (pos - 1) / 2;
+        if (rank_value(h->item[parent], r) >= v) break;
+        heap_set(h, r, pos, h->item[parent]);
+        pos = parent;
+    }
+    heap_set(h, r, pos, node);
+}
+
+static void sift_down(Heap* h, FleetRank r, unsigned pos) {
+    int node = h->item[pos];
+    float v = rank_value(node, r);
+    for (;;) {
+        unsigned child = 2 * pos + 1;
+        if (child >= h->size) break;
+        if (child + 1 < h->size && rank_value(h->item[child + 1], r) > rank_value(h->item[child], r)) child++;
+        if (rank_value(h->item[child], r) <= v) break;
+        heap_set(h, r, pos, h->item[child]);
+        pos = child;
+    }
+    heap_set(h, r, pos, node);
+}
+
+static void heap_insert(FleetRank r, int node) {
+    Heap* h = &g_heap[r];
+    heap_set(h, r, h->size++, node);
+    sift_up(h, r, h->size - 1);
+}
+
+static void heap_remove(FleetRank r, int node) {
+    Heap* h = &g_heap[r];
+    unsigned pos = (unsigned)g_nodes[node].heap_pos[r];
+    unsigned last = --h->size;
+    g_nodes[node].heap_pos[r] = -1;
+    if (pos == last) return;
+    int moved = h->item[last];
+    heap_set(h, r, pos, moved);
+    sift_up(h, r, pos);
+    sift_down(h, r, (unsigned)g_nodes[moved].heap_pos[r]);
+}
+
+// the key of node changed: it moves up or down, never both
+static void heap_update(FleetRank r, int node) {
+    Heap* h = &g_heap[r];
+    unsigned pos = (unsigned)g_nodes[node].heap_pos[r];
+    sift_up(h, r, pos);
+    sift_down(h, r, (unsigned)g_nodes[node].heap_pos[r]);
+}
+
+static uint32_t name_hash(const char* s) {
+    uint32_t h = 2166136261u;
+    while (*s) h = (h ^ (uint8_t)*s++) * 16777619u;
+    return h;
+}
+
+// node index, -1 when the table is full
+static int node_lookup(const char* name) {
+    unsigned slot = name_hash(name) & (HASH_SLOTS - 1);
+    for (;;) {
+        int idx = g_hash[slot];
+        if (idx < 0) break;
+        if (strcmp(g_nodes[idx].last.node, name) == 0) return idx;
+        slot = (slot + 1) & (HASH_SLOTS - 1);
+    }
+    if (g_node_count >= FLEET_MAX_NODES) return -1;
+
+    int idx = (int)g_node_count++;
+    Node* n = &g_nodes[idx];
+    memset(n, 0, sizeof(*n));
+    memcpy(n->last.node, name, sizeof(n->last.node));
+    for (int r = 0; r < FLEET_RANK_COUNT; r++) n->heap_pos[r] = -1;
+    g_hash[slot] = (short)idx;
+    return idx;
+}
+
+static void ingest(const FleetSample* s, uint64_t now) {
+    int idx = node_lookup(s->node);
+    if (idx < 0) {
+        g_bad++;
+        return;
+    }
+    Node* n = &g_nodes[idx];
+
+    // a lower seq is a restarted sender, not a gap
+    if (n->last.seq && s->seq > n->last.seq + 1) g_lost += s->seq - n->last.seq - 1;
+    n->last = *s;
+    n->last_seen_ns = now;
+    g_received++;
+
+    for (int r = 0; r < FLEET_RANK_COUNT; r++) {
+        if (n->fresh) heap_update((FleetRank)r, idx);
+        else heap_insert((FleetRank)r, idx);
+    }
+    n->fresh = 1;
+}
+
+static unsigned sweep_stale(uint64_t now) {
+    unsigned stale = 0;
+    for (unsigned i = 0; i < g_node_count; i++) {
+        Node* n = &g_nodes[i];
+        if (n->fresh && now - n->last_seen_ns > FLEET_STALE_MS * 1000000ULL) {
+            for (int r = 0; r < FLEET_RANK_COUNT; r++) heap_remove((FleetRank)r, (int)i);
+            n->fresh = 0;
+        }
+        if (!n->fresh) stale++;
+    }
+    return stale;
+}
+
+// top K off the heap: a frontier of candidate positions, best one out, its children in
+static unsigned top_k(FleetRank r, FleetEntry* out, uint64_t now) {
+    const Heap* h = &g_heap[r];
+    unsigned frontier[2 * FLEET_TOP_K + 1];
+    unsigned nf = 0, n = 0;
+
+    if (h->size) frontier[nf++] = 0;
+    while (n < FLEET_TOP_K && nf > 0) {
+        unsigned best = 0;
+        for (unsigned i = 1; i < nf; i++)
+            if (rank_value(h->item[frontier[i]], r) > rank_value(h->item[frontier[best]], r)) best = i;
+        unsigned pos = frontier[best];
+        frontier[best] = frontier[--nf];
+
+        const Node* node = &g_nodes[h->item[pos]];
+        FleetEntry* e = &out[n++];
+        memcpy(e->node, node->last.node, sizeof(e->node));
+        e->value = rank_value(h->item[pos], r);
+        e->core = node->last.busiest_core;
+        e->age_ms = (uint32_t)((now - node->last_seen_ns) / 1000000ULL);
+
+        if (2 * pos + 1 < h->size) frontier[nf++] = 2 * pos + 1;
+        if (2 * pos + 2 < h->size) frontier[nf++] = 2 * pos + 2;
+    }
+    return n;
+}
+
+static void publish(const FleetView* v) {
+    unsigned seq = atomic_load_explicit(&g_view_seq, memory_order_relaxed);
+    atomic_store_explicit(&g_view_seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    g_view = *v;
+    atomic_store_explicit(&g_view_seq, seq + 2, memory_order_release);
+}
+
+static void* receiver_main(void* arg) {
+    (void)arg;
+
+    static struct mmsghdr msgs[RECV_BATCH];
+    static struct iovec iov[RECV_BATCH];
+    static uint8_t bufs[RECV_BATCH][FLEET_DATAGRAM_MAX];
+
+    for (unsigned i = 0; i < RECV_BATCH; i++) {
+        iov[i].iov_base = bufs[i];
+        iov[i].iov_len = FLEET_DATAGRAM_MAX;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    uint64_t next_tick = mono_ns();
+    uint64_t rate_ns = next_tick, rate_received = 0, rate_batches = 0;
+    double rate = 0.0, batch_mean = 0.0;
+    static FleetView view;
+
+    while (atomic_load_explicit(&g_running, memory_order_relaxed)) {
+        struct pollfd pfd = { .fd = g_fd, .events = POLLIN };
+        uint64_t now = mono_ns();
+        int wait_ms = next_tick > now ? (int)((next_tick - now) / 1000000ULL) + 1 : 0;
+
+        if (poll(&pfd, 1, wait_ms) > 0) {
+            // drain everything queued, a batch per syscall
+            for (;;) {
+                int n = recvmmsg(g_fd, msgs, RECV_BATCH, MSG_DONTWAIT, NULL);
+                if (n <= 0) break;
+                g_batches++;
+                now = mono_ns();
+                for (int i = 0; i < n; i++) {
+                    FleetSample s;
+                    if (fleet_decode(bufs[i], msgs[i].msg_len, &s) == 0) ingest(&s, now);
+                    else g_bad++;
+                }
+                if (n < RECV_BATCH) break;
+            }
+        }
+
+        now = mono_ns();
+        if (now < next_tick) continue;
+        next_tick = now + TICK_MS * 1000000ULL;
+
+        if (now - rate_ns >= 1000000000ULL) {
+            double dt = (double)(now - rate_ns) / 1e9;
+            rate = (double)(g_received - rate_received) / dt;
+            batch_mean = g_batches > rate_batches ? (double)(g_received - rate_received) / (double)(g_batches - rate_batches) : 0.0;
+            rate_ns = now;
+            rate_received = g_received;
+            rate_batches = g_batches;
+        }
+
+        view.published_ns = now;
+        view.stale = sweep_stale(now);
+        view.nodes = g_node_count;
+        view.received = g_received;
+        view.lost = g_lost;
+        view.bad = g_bad;
+        view.datagrams_per_s = rate;
+        view.batch_mean = batch_mean;
+        for (int r = 0; r < FLEET_RANK_COUNT; r++) view.top_count[r] = top_k((FleetRank)r, view.top[r], now);
+        publish(&view);
+    }
+    return NULL;
+}
+
+static int bind_udp(uint16_t port) {
+    // dual stack first, plain IPv4 where IPv6 is off
+    int fd = socket(AF_INET6, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0) {
+        int off = 0;
+        setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+        struct sockaddr_in6 a;
+        memset(&a, 0, sizeof(a));
+        a.sin6_family = AF_INET6;
+        a.sin6_addr = in6addr_any;
+        a.sin6_port = htons(port);
+        if (bind(fd, (struct sockaddr*)&a, sizeof(a)) == 0) return fd;
+        close(fd);
+    }
+
+    fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_in a;
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_ANY);
+    a.sin_port = htons(port);
+    if (bind(fd, (struct sockaddr*)&a, sizeof(a)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static uint16_t bound_port(int fd) {
+    struct sockaddr_storage ss;
+    socklen_t len = sizeof(ss);
+    if (getsockname(fd, (struct sockaddr*)&ss, &len) != 0) return 0;
+    if (ss.ss_family == AF_INET6) return ntohs(((struct sockaddr_in6*)&ss)->sin6_port);
+    return ntohs(((struct sockaddr_in*)&ss)->sin_port);
+}
+
+/* =======================
+ * Public API
+ * ======================= */
+
+int fleet_aggregator_start(uint16_t port) {
+    if (atomic_load(&g_running)) return -1;
+
+    g_fd = bind_udp(port);
+    if (g_fd < 0) return -1;
+
+    int rcvbuf = RECV_BUFFER;
+    setsockopt(g_fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    g_port = bound_port(g_fd);
+
+    memset(g_hash, 0xff, sizeof(g_hash));
+    memset(g_heap, 0, sizeof(g_heap));
+    g_node_count = 0;
+    g_received = g_lost = g_bad = g_batches = 0;
+    atomic_store(&g_view_seq, 0);
+
+    atomic_store(&g_running, 1);
+    if (pthread_create(&g_thread, NULL, receiver_main, NULL) != 0) {
+        atomic_store(&g_running, 0);
+        close(g_fd);
+        g_fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+int fleet_aggregator_running(void) {
+    return atomic_load_explicit(&g_running, memory_order_relaxed);
+}
+
+uint16_t fleet_aggregator_port(void) {
+    return g_port;
+}
+
+int fleet_aggregator_view(FleetView* out) {
+    if (!fleet_aggregator_running()) return -1;
+
+    unsigned before, after = 0;
+    do {
+        before = atomic_load_explicit(&g_view_seq, memory_order_acquire);
+        if (before & 1) continue;
+        *out = g_view;
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&g_view_seq, memory_order_relaxed);
+    } while ((before & 1) || before != after);
+
+    return before == 0 ? -1 : 0;
+}
+
+void fleet_aggregator_stop(void) {
+    if (!atomic_load(&g_running)) return;
+    atomic_store(&g_running, 0);
+    pthread_join(g_thread, NULL);
+    close(g_fd);
+    g_fd = -1;
+}
@@ -0,0 +1,78 @@
+#define _DEFAULT_SOURCE
+#include "fleet/bench.h"
+#include "fleet/aggregator.h"
+#include "fleet/sender.h"
+#include "diag/self_stats.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* =======================
+ * Internal structures
+ * ======================= */
+
+#define BENCH_WARMUP_MS  500
+#define BENCH_MS         5000
+#define BENCH_DRAIN_MS   300
+
+/* =======================
+ * Helpers
+ * ======================= */
+
+static void sleep_ms(long ms) {
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+/* =======================
+ * Public API
+ * ======================= */
+
+int fleet_benchmark(unsigned nodes) {
+    if (fleet_aggregator_start(0) != 0) {
+        perror("fleet aggregator");
+        return 1;
+    }
+
+    if (fleet_simulate_start(fleet_aggregator_port(), nodes, 0) != 0) {
+        fprintf(stderr, "cannot start %u simulated senders\n", nodes);
+        fleet_aggregator_stop();
+        return 1;
+    }
+
+    // let every simulated node show up once before counting
+    sleep_ms(BENCH_WARMUP_MS);
+
+    FleetView start, end;
+    memset(&start, 0, sizeof(start));
+    fleet_aggregator_view(&start);
+    uint64_t sent0 = fleet_simulate_sent();
+    uint64_t t0 = diag_now_ns();
+
+    sleep_ms(BENCH_MS);
+
+    uint64_t sent1 = fleet_simulate_sent();
+    uint64_t t1 = diag_now_ns();
+    fleet_simulate_stop();
+
+    // the receiver drains what is still queued and publishes within a tick
+    sleep_ms(BENCH_DRAIN_MS);
+    memset(&end, 0, sizeof(end));
+    fleet_aggregator_view(&end);
+    fleet_aggregator_stop();
+
+    double secs = (double)(t1 - t0) / 1e9;
+    double sent = (double)(sent1 - sent0);
+    double received = (double)(end.received - start.received);
+    double lost = sent > received ? sent - received : 0.0;
+
+    printf("fleet bench: %u nodes, %.1f s\n", nodes, secs);
+    printf("  sent      %12.0f datagrams/s\n", sent / secs);
+    printf("  received  %12.0f datagrams/s  (%.1f per recvmmsg)\n", received / secs, end.batch_mean);
+    printf("  dropped   %12.0f datagrams/s  (%.2f %%, seq gaps %llu)\n", lost / secs,
+           sent > 0.0 ? 100.0 * lost / sent : 0.0, (unsigned long long)(end.lost - start.lost));
+    printf("  nodes     %12u  bad %llu\n", end.nodes, (unsigned long long)end.bad);
+
+    return 0;
+}
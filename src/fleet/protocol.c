@@ -0,0 +1,108 @@
+#define _DEFAULT_SOURCE
+#include "fleet/protocol.h"
+#include "stream/format.h"
+
+#include <math.h>
+#include <string.h>
+
+/* =======================
+ * Helpers
+ * ======================= */
+
+static size_t put_fixed(uint8_t* p, double v, double scale) {
+    return stream_put_varint(p, stream_zigzag(llround(v * scale)));
+}
+
+static int get_value(const uint8_t* buf, size_t len, size_t* off, int64_t* out) {
+    uint64_t v;
+    size_t n = stream_get_varint(buf + *off, len - *off, &v);
+    if (!n) return -1;
+    *off += n;
+    *out = stream_unzigzag(v);
+    return 0;
+}
+
+/* =======================
+ * Public API
+ * ======================= */
+
+void fleet_sample_from_stats(FleetSample* out, const HardwareStats* s) {
+    out->cpu_percent = (float)s->cpu_usage_percent;
+    out->busiest_core = 0;
+    out->busiest_core_percent = 0.0f;
+    for (unsigned i = 0; i < s->core_count && i < HW_MAX_CORES; i++) {
+        if (s->core_usage_percent[i] > out->busiest_core_percent) {
+            out->busiest_core_percent = (float)s->core_usage_percent[i];
+            out->busiest_core = (uint16_t)i;
+        }
+    }
+    out->temp_c = (float)s->cpu_temp_c;
+    out->mem_used_percent = (float)s->mem_used_percent;
+    out->mem_available_kb = s->mem_available_kb > 0 ? (uint64_t)s->mem_available_kb : 0;
+    out->load1 = (float)s->load1;
+    out->psi_memory_some10 = (float)s->psi[PSI_MEMORY].some_avg10;
+}
+
+size_t fleet_encode(const FleetSample* s, uint8_t* buf) {
+    size_t n = 0;
+    memcpy(buf, FLEET_MAGIC, FLEET_MAGIC_LEN);
+    n += FLEET_MAGIC_LEN;
+    buf[n++] = FLEET_VERSION;
+
+    size_t name_len = strnlen(s->node, FLEET_NODE_MAX - 1);
+    n += stream_put_varint(buf + n, name_len);
+    memcpy(buf + n, s->node, name_len);
+    n += name_len;
+
+    n += stream_put_varint(buf + n, s->seq);
+    n += put_fixed(buf + n, s->cpu_percent, 100.0);
+    n += put_fixed(buf + n, s->busiest_core_percent, 100.0);
+    n += stream_put_varint(buf + n, s->busiest_core);
+    n += put_fixed(buf + n, s->temp_c, 10.0);
+    n += put_fixed(buf + n, s->mem_used_percent, 100.0);
+    n += stream_put_varint(buf + n, s->mem_available_kb);
+    n += put_fixed(buf + n, s->load1, 100.0);
+    n += put_fixed(buf + n, s->psi_memory_some10, 100.0);
+    return n;
+}
+
+int fleet_decode(const uint8_t* buf, size_t len, FleetSample* out) {
+    if (len < FLEET_MAGIC_LEN + 1 || memcmp(buf, FLEET_MAGIC, FLEET_MAGIC_LEN) != 0 ||
+        buf[FLEET_MAGIC_LEN] != FLEET_VERSION)
+        return -1;
+
+    size_t off = FLEET_MAGIC_LEN + 1;
+    uint64_t u;
+    size_t c = stream_get_varint(buf + off, len - off, &u);
+    if (!c || u == 0 || u >= FLEET_NODE_MAX || len - off - c < u) return -1;
+    off += c;
+    memcpy(out->node, buf + off, u);
+    out->node[u] = '\0';
+    off += u;
+
+    int64_t v[6];
+    c = stream_get_varint(buf + off, len - off, &u);
+    if (!c) return -1;
+    off += c;
+    out->seq = (uint32_t)u;
+
+    // core index and available kB are plain varints, not zigzag
+    uint64_t core, avail;
+    if (get_value(buf, len, &off, &v[0]) || get_value(buf, len, &off, &v[1])) return -1;
+    if (!(c = stream_get_varint(buf + off, len - off, &core))) return -1;
+    off += c;
+    if (get_value(buf, len, &off, &v[2]) || get_value(buf, len, &off, &v[3])) return -1;
+    if (!(c = stream_get_varint(buf + off, len - off, &avail))) return -1;
+    off += c;
+    if (get_value(buf, len, &off, &v[4]) || get_value(buf, len, &off, &v[5])) return -1;
+
+    out->cpu_percent = (float)v[0] / 100.0f;
+    out->busiest_core_percent = (float)v[1] / 100.0f;
+    out->busiest_core = (uint16_t)core;
+    out->temp_c = (float)v[2] / 10.0f;
+    out->mem_used_percent = (float)v[3] / 100.0f;
+    out->mem_available_kb = avail;
+    out->load1 = (float)v[4] / 100.0f;
+    out->psi_memory_some10 = (float)v[5] / 100.0f;
+    return 0;
+}
@@ -0,0 +1,264 @@
+#define _GNU_SOURCE
+#include "fleet/sender.h"
+#include "fleet/protocol.h"
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+/* =======================
+ * Internal structures
+ * ======================= */
+
+#define SIM_THREADS_MAX 4
+#define SIM_BATCH       64          // datagrams per sendmmsg()
+#define SIM_CORES       8
+
+static int      g_fd = -1;
+static char     g_node[FLEET_NODE_MAX];
+static uint32_t g_seq = 0;
+static uint64_t g_last_ns = 0;
+
+typedef struct {
+    pthread_t   thread;
+    int         fd;
+    unsigned    first, count;       // simulated node range
+    unsigned    hz;
+    uint64_t    rng;
+} SimThread;
+
+static SimThread        g_sim[SIM_THREADS_MAX];
+static unsigned         g_sim_threads = 0;
+static atomic_int       g_sim_running = 0;
+static _Atomic uint64_t g_sim_sent = 0;
+
+/* =======================
+ * Helpers
+ * ======================= */
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int udp_connect(const char* host, const char* port) {
+    struct addrinfo hints, *res = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(host, port, &hints, &res) != 0) return -1;
+
+    int fd = -1;
+    for (struct addrinfo* ai = res; ai && fd < 0; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd >= 0 && connect(fd, ai->ai_addr, ai->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+
+static uint64_t xorshift(uint64_t* s) {
+    *s ^= *s << 13;
+    *s ^= *s >> 7;
+    *s ^= *s << 17;
+    return *s;
+}
+
+// uniform in [-1, 1)
+static float jitter(uint64_t* s) {
+    return (float)((double)(xorshift(s) >> 11) / (double)(1ULL << 52)) - 1.0f;
+}
+
+static float clampf(float v, float lo, float hi) {
+    return v < lo ? lo : v > hi ? hi : v;
+}
+
+static void sim_step(FleetSample* s, uint64_t* rng) {
+    s->cpu_percent = clampf(s->cpu_percent + 8.0f * jitter(rng), 0.0f, 100.0f);
+    s->busiest_core_percent = clampf(s->cpu_percent + 20.0f * (jitter(rng) + 1.0f), 0.0f, 100.0f);
+    s->busiest_core = (uint16_t)(xorshift(rng) % SIM_CORES);
+    s->temp_c = clampf(s->temp_c + 0.5f * jitter(rng), 35.0f, 90.0f);
+    s->mem_used_percent = clampf(s->mem_used_percent + 0.3f * jitter(rng), 10.0f, 99.5f);
+    s->mem_available_kb = (uint64_t)((100.0f - s->mem_used_percent) * 40960.0f);   // of 4 GiB
+    s->load1 = clampf(s->load1 + 0.1f * jitter(rng), 0.0f, 16.0f);
+    s->psi_memory_some10 = s->mem_used_percent > 95.0f ? clampf(s->psi_memory_some10 + jitter(rng), 0.0f, 50.0f) : 0.0f;
+    s->seq++;
+}
+
+static void* sim_main(void* arg) {
+    SimThread* t = arg;
+
+    FleetSample* nodes = calloc(t->count, sizeof(*nodes));
+    uint8_t (*bufs)[FLEET_DATAGRAM_MAX] = malloc(SIM_BATCH * sizeof(*bufs));
+    if (!nodes || !bufs) {
+        free(nodes);
+        free(bufs);
+        return NULL;
+    }
+
+    for (unsigned i = 0; i < t->count; i++) {
+        snprintf(nodes[i].node, FLEET_NODE_MAX, "sim%04u", t->first + i);
+        nodes[i].cpu_percent = 50.0f * (jitter(&t->rng) + 1.0f);
+        nodes[i].temp_c = 55.0f + 10.0f * jitter(&t->rng);
+        nodes[i].mem_used_percent = 60.0f + 30.0f * jitter(&t->rng);
+    }
+
+    struct mmsghdr msgs[SIM_BATCH];
+    struct iovec iov[SIM_BATCH];
+    uint64_t period = t->hz ? 1000000000ULL / t->hz : 0;
+    uint64_t next = mono_ns();
+    unsigned node = 0;
+
+    while (atomic_load_explicit(&g_sim_running, memory_order_relaxed)) {
+        // paced: every node once per period; flat out: just keep cycling
+        unsigned todo = t->count;
+        while (todo > 0 && atomic_load_explicit(&g_sim_running, memory_order_relaxed)) {
+            unsigned n = todo < SIM_BATCH ? todo : SIM_BATCH;
+            for (unsigned k = 0; k < n; k++) {
+                FleetSample* s = &nodes[node];
+                sim_step(s, &t->rng);
+                iov[k].iov_base = bufs[k];
+                iov[k].iov_len = fleet_encode(s, bufs[k]);
+                memset(&msgs[k], 0, sizeof(msgs[k]));
+                msgs[k].msg_hdr.msg_iov = &iov[k];
+                msgs[k].msg_hdr.msg_iovlen = 1;
+                node = (node + 1) % t->count;
+            }
+            int sent = sendmmsg(t->fd, msgs, n, 0);
+            if (sent > 0) atomic_fetch_add_explicit(&g_sim_sent, (uint64_t)sent, memory_order_relaxed);
+            todo -= n;
+        }
+
+        if (period) {
+            next += period;
+            uint64_t now = mono_ns();
+            if (next > now) {
+                struct timespec ts = { (time_t)((next - now) / 1000000000ULL), (long)((next - now) % 1000000000ULL) };
+                nanosleep(&ts, NULL);
+            } else {
+                next = now;
+            }
+        }
+    }
+
+    free(nodes);
+    free(bufs);
+    return NULL;
+}
+
+/* =======================
+ * Public API
+ * ======================= */
+
+int fleet_sender_open(const char* target) {
+    if (g_fd >= 0 || !target) return -1;
+
+    char host[256];
+    char portbuf[16];
+    const char* port = portbuf;
+    snprintf(host, sizeof(host), "%s", target);
+    snprintf(portbuf, sizeof(portbuf), "%u", FLEET_DEFAULT_PORT);
+
+    // "host:port", "[v6]:port", or a bare host / v6 address
+    if (host[0] == '[') {
+        char* close = strchr(host, ']');
+        if (!close) return -1;
+        *close = '\0';
+        if (close[1] == ':') port = close + 2;
+        memmove(host, host + 1, strlen(host));
+    } else {
+        char* colon = strchr(host, ':');
+        if (colon && !strchr(colon + 1, ':')) {
+            *colon = '\0';
+            port = colon + 1;
+        }
+    }
+
+    g_fd = udp_connect(host, port);
+    if (g_fd < 0) return -1;
+
+    if (gethostname(g_node, sizeof(g_node)) != 0) snprintf(g_node, sizeof(g_node), "unknown");
+    g_node[sizeof(g_node) - 1] = '\0';
+    g_seq = 0;
+    g_last_ns = 0;
+    return 0;
+}
+
+int fleet_sender_is_open(void) {
+    return g_fd >= 0;
+}
+
+void fleet_sender_tick(const HardwareStats* s, uint64_t now_ns) {
+    if (g_fd < 0 || (g_last_ns && now_ns - g_last_ns < FLEET_SEND_PERIOD_MS * 1000000ULL)) return;
+    g_last_ns = now_ns;
+
+    FleetSample fs;
+    memset(&fs, 0, sizeof(fs));
+    memcpy(fs.node, g_node, sizeof(fs.node));
+    fs.seq = ++g_seq;
+    fleet_sample_from_stats(&fs, s);
+
+    uint8_t buf[FLEET_DATAGRAM_MAX];
+    size_t n = fleet_encode(&fs, buf);
+
+    // an aggregator that is down or unreachable is not our problem
+    (void)send(g_fd, buf, n, MSG_DONTWAIT | MSG_NOSIGNAL);
+}
+
+void fleet_sender_close(void) {
+    if (g_fd >= 0) close(g_fd);
+    g_fd = -1;
+}
+
+int fleet_simulate_start(uint16_t port, unsigned nodes, unsigned hz) {
+    if (g_sim_threads || nodes == 0) return -1;
+
+    char p[16];
+    snprintf(p, sizeof(p), "%u", port);
+
+    unsigned threads = nodes < SIM_THREADS_MAX ? nodes : SIM_THREADS_MAX;
+    atomic_store(&g_sim_running, 1);
+    atomic_store(&g_sim_sent, 0);
+
+    for (unsigned i = 0; i < threads; i++) {
+        SimThread* t = &g_sim[i];
+        memset(t, 0, sizeof(*t));
+        t->first = nodes * i / threads;
+        t->count = nodes * (i + 1) / threads - t->first;
+        t->hz = hz;
+        t->rng = 0x9e3779b97f4a7c15ULL * (i + 1);
+        t->fd = udp_connect("127.0.0.1", p);
+        if (t->fd < 0 || pthread_create(&t->thread, NULL, sim_main, t) != 0) {
+            if (t->fd >= 0) close(t->fd);
+            g_sim_threads = i;
+            fleet_simulate_stop();
+            return -1;
+        }
+        g_sim_threads = i + 1;
+    }
+    return 0;
+}
+
+uint64_t fleet_simulate_sent(void) {
+    return atomic_load_explicit(&g_sim_sent, memory_order_relaxed);
+}
+
+void fleet_simulate_stop(void) {
+    atomic_store(&g_sim_running, 0);
+    for (unsigned i = 0; i < g_sim_threads; i++) {
+        pthread_join(g_sim[i].thread, NULL);
+        close(g_sim[i].fd);
+    }
+    g_sim_threads = 0;
+}
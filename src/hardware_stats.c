@@ -1,16 +1,58 @@
 #define _GNU_SOURCE
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 #include "hardware_stats.h"
+#include "collectors/net_dev.h"
+#include "diag/perf_counters.h"
+#include "diag/self_stats.h"
+#include "fleet/sender.h"
+#include "history/ring.h"
+#include "stats/estimators.h"
+#include "stats/fields.h"
+#include "sched/scheduler.h"
 
 static unsigned long long previous_total       = 0;
 static unsigned long long previous_idle        = 0;
 static                int previous_initialized = 0;
 
+static unsigned long long previous_core_total[HW_MAX_CORES];
+static unsigned long long previous_core_idle[HW_MAX_CORES];
+static unsigned char      previous_core_valid[HW_MAX_CORES];
 
-static int read_cpu_times(unsigned long long *total_out, unsigned long long *idle_out){
+
+static int parse_cpu_line(const char* line, unsigned long long* total_out, unsigned long long* idle_out){
+
+    char cpu_label[8];
+    unsigned long long user_state = 0, nice_state = 0, system_state = 0, idle_state = 0, iowait_state = 0, irq_state = 0, softirq_state = 0, steal_state = 0, guest_state = 0, guest_nice_state = 0;
+
+    int count_read = sscanf(line, "%7s %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu",
+                                   cpu_label, &user_state, &nice_state, &system_state, &idle_state, &iowait_state,
+                                   &irq_state, &softirq_state, &steal_state, &guest_state, &guest_nice_state);
+    
+    if(count_read < 5) return -1;
+
+    unsigned long long non_idle_state = user_state + nice_state + system_state + irq_state + softirq_state + steal_state + guest_state + guest_nice_state;
+    unsigned long long idle_all_state = idle_state + iowait_state;
+    unsigned long long total_time     = non_idle_state + idle_all_state;
+
+    *total_out = total_time;
+    *idle_out  = idle_all_state;
+
+    return 0;
+
+}
+
+
+// aggregate "cpu" line plus every "cpuN" line; core arrays are indexed by N
+static int read_cpu_times(unsigned long long *total_out, unsigned long long *idle_out,
+                          unsigned long long core_total[HW_MAX_CORES], unsigned long long core_idle[HW_MAX_CORES],
+                          unsigned char core_seen[HW_MAX_CORES], unsigned* core_count_out){
 
     FILE* f = fopen("/proc/stat", "r");
     
@@ -18,45 +60,88 @@ static int read_cpu_times(unsigned long long *total_out, unsigned long long *idl
 
     char line[256];
 
-    if(!fgets(line, sizeof(line), f)) {
+    if(!fgets(line, sizeof(line), f) || parse_cpu_line(line, total_out, idle_out) != 0) {
 
         fclose(f);
         return -1;
     }
 
-    fclose(f);
+    unsigned core_count = 0;
 
-    char cpu_label[4];
-    unsigned long long user_state, nice_state, system_state, idle_state, iowait_state, irq_state, softirq_state, steal_state, guest_state, guest_nice_state;
+    memset(core_seen, 0, HW_MAX_CORES);
 
-    int count_read = sscanf(line, "%3s %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu",
-                                   cpu_label, &user_state, &nice_state, &system_state, &idle_state, &iowait_state,
-                                   &irq_state, &softirq_state, &steal_state, &guest_state, &guest_nice_state);
-    
-    if(count_read < 5) return -1;
+    while(fgets(line, sizeof(line), f) && strncmp(line, "cpu", 3) == 0){
 
-    unsigned long long non_idle_state = user_state + nice_state + system_state + irq_state + softirq_state + steal_state + guest_state + guest_nice_state;
-    unsigned long long idle_all_state = idle_state + iowait_state;
-    unsigned long long total_time     = non_idle_state + idle_all_state;
+        unsigned index = (unsigned)strtoul(line + 3, NULL, 10);
 
-    *total_out = total_time;
-    *idle_out  = idle_all_state;
+        if(index >= HW_MAX_CORES) continue;
 
+        if(parse_cpu_line(line, &core_total[index], &core_idle[index]) != 0) continue;
+
+        core_seen[index] = 1;
+
+        if(index + 1 > core_count) core_count = index + 1;
+
+    }
+
+    fclose(f);
+
+    *core_count_out = core_count;
 
     return 0;
 
 }
 
 
+static double usage_percent(unsigned long long total_diff, unsigned long long idle_diff){
+
+    if(total_diff == 0) return 0.0;
+
+    double usage = 100.0 * (double)(total_diff - idle_diff) / (double)total_diff;
 
-static double calc_cpu_usage_time(){
+    if(usage < 0.0)   usage = 0.0;
+
+    if(usage > 100.0) usage = 100.0;
+
+    return usage;
+
+}
+
+
+
+static double calc_cpu_usage_time(HardwareStats* out){
 
     unsigned long long total = 0;
     unsigned long long idle  = 0;
 
-    if(read_cpu_times(&total, &idle) != 0) return -1.0;
+    unsigned long long core_total[HW_MAX_CORES];
+    unsigned long long core_idle[HW_MAX_CORES];
+    unsigned char      core_seen[HW_MAX_CORES];
+    unsigned           core_count = 0;
+
+    if(read_cpu_times(&total, &idle, core_total, core_idle, core_seen, &core_count) != 0) return -1.0;
+
+    out->core_count = core_count;
+
+    for(unsigned i = 0; i < core_count; i++){
+
+        // offline cores (or the first sample) have no delta yet
+        if(core_seen[i] && previous_core_valid[i] && core_total[i] >= previous_core_total[i]){
+
+            out->core_usage_percent[i] = usage_percent(core_total[i] - previous_core_total[i], core_idle[i] - previous_core_idle[i]);
+
+        }
+
+        else out->core_usage_percent[i] = 0.0;
 
-    if(!previous_initialized) {
+        previous_core_total[i] = core_total[i];
+        previous_core_idle[i]  = core_idle[i];
+        previous_core_valid[i] = core_seen[i];
+
+    }
+
+    // a total below the last one: counters adopted from history belong to an earlier boot
+    if(!previous_initialized || total < previous_total) {
 
         previous_total       = total;
         previous_idle        = idle;
@@ -73,49 +158,262 @@ static double calc_cpu_usage_time(){
     previous_total = total;
     previous_idle  = idle;
 
-    if(total_diff == 0) return 0.0;
+    return usage_percent(total_diff, idle_diff);
+}
 
-    double usage = 100.0 * (double)(total_diff - idle_diff) / (double)total_diff;
 
-    if(usage < 0.0)   usage = 0.0;
 
-    if(usage > 100.0) usage = 100.0;
+// /proc/meminfo and /proc/vmstat are parsed in a single pass each. Keys are hashed
+// while they are scanned and looked up in a small perfect-hash table, so unknown
+// keys cost one probe and one length check no matter how many fields we extract.
+
+typedef struct {
+
+    const char* key;
+    size_t      key_len;
+    size_t      offset;     // where the value goes inside the target struct
+
+} KeyedField;
+
+typedef struct {
+
+    const KeyedField* fields;
+    size_t            field_count;
+    uint32_t          seed;         // picked so that every key of `fields` lands in its own slot
+    unsigned          mask;
+    int               wide;         // 1: unsigned long long slots, 0: long slots
+    signed char       slots[64];    // -1 empty, otherwise index into fields
+    int               built;
+
+} KeyedTable;
+
+
+typedef struct {
+
+    unsigned long long pgfault, pgmajfault;
+    unsigned long long pswpin, pswpout;
+    unsigned long long pgpgin, pgpgout;
+    unsigned long long pgsteal_kswapd, pgsteal_direct;
+    unsigned long long allocstall_normal;
+    unsigned long long oom_kill;
+
+} VmCounters;
+
+
+#define MEMINFO_FIELD(key, member) { key, sizeof(key) - 1, offsetof(HardwareStats, member) }
+#define VMSTAT_FIELD(member)       { #member, sizeof(#member) - 1, offsetof(VmCounters, member) }
+
+static const KeyedField meminfo_fields[] = {
+
+    MEMINFO_FIELD("MemTotal",     mem_total_kb),
+    MEMINFO_FIELD("MemFree",      mem_free_kb),
+    MEMINFO_FIELD("MemAvailable", mem_available_kb),
+    MEMINFO_FIELD("Buffers",      mem_buffers_kb),
+    MEMINFO_FIELD("Cached",       mem_cached_kb),
+    MEMINFO_FIELD("SwapCached",   swap_cached_kb),
+    MEMINFO_FIELD("Active",       mem_active_kb),
+    MEMINFO_FIELD("Inactive",     mem_inactive_kb),
+    MEMINFO_FIELD("Dirty",        mem_dirty_kb),
+    MEMINFO_FIELD("Writeback",    mem_writeback_kb),
+    MEMINFO_FIELD("AnonPages",    mem_anon_kb),
+    MEMINFO_FIELD("Mapped",       mem_mapped_kb),
+    MEMINFO_FIELD("Shmem",        mem_shmem_kb),
+    MEMINFO_FIELD("Slab",         mem_slab_kb),
+    MEMINFO_FIELD("SReclaimable", mem_sreclaimable_kb),
+    MEMINFO_FIELD("SUnreclaim",   mem_sunreclaim_kb),
+    MEMINFO_FIELD("KernelStack",  mem_kernel_stack_kb),
+    MEMINFO_FIELD("PageTables",   mem_page_tables_kb),
+    MEMINFO_FIELD("SwapTotal",    swap_total_kb),
+    MEMINFO_FIELD("SwapFree",     swap_free_kb),
+    MEMINFO_FIELD("Committed_AS", mem_committed_kb),
+    MEMINFO_FIELD("CommitLimit",  mem_commit_limit_kb),
+
+};
+
+static const KeyedField vmstat_fields[] = {
+
+    VMSTAT_FIELD(pgfault),
+    VMSTAT_FIELD(pgmajfault),
+    VMSTAT_FIELD(pswpin),
+    VMSTAT_FIELD(pswpout),
+    VMSTAT_FIELD(pgpgin),
+    VMSTAT_FIELD(pgpgout),
+    VMSTAT_FIELD(pgsteal_kswapd),
+    VMSTAT_FIELD(pgsteal_direct),
+    VMSTAT_FIELD(allocstall_normal),
+    VMSTAT_FIELD(oom_kill),
+
+};
+
+static KeyedTable meminfo_table = {meminfo_fields, sizeof(meminfo_fields) / sizeof(meminfo_fields[0]), 9, 63, 0, {0}, 0};
+
+static KeyedTable vmstat_table  = {vmstat_fields, sizeof(vmstat_fields) / sizeof(vmstat_fields[0]), 13, 31, 1, {0}, 0};
+
+
+static int    meminfo_fd = -1;
+static int    vmstat_fd  = -1;
+static char   keyed_buf[16384];
+
+static VmCounters previous_vm;
+static double     previous_vm_time = 0.0;
+
+
+static uint32_t keyed_hash_step(uint32_t h, unsigned char c){
+
+    h ^= c;
+    return h * 16777619u;     // FNV-1a
 
-    return usage;
 }
 
 
+static unsigned keyed_slot(uint32_t h, unsigned mask){
 
-static int read_memory_info(long* total_kb_out, long* available_kb_out){
+    return (h ^ (h >> 16)) & mask;
 
-    FILE* f = fopen("/proc/meminfo", "r");
+}
 
-    if(!f) return -1;
 
-    char label[64];
-    long data;
-    char mem_unit[16];
+static int keyed_table_build(KeyedTable* t){
 
+    memset(t->slots, -1, sizeof(t->slots));
 
-    long mem_total     = -1;
-    long mem_available = -1;
+    for(size_t i = 0; i < t->field_count; i++){
 
+        uint32_t h = t->seed;
 
-    while(fscanf(f, "%63s %ld %15s\n", label, &data, mem_unit) == 3){
+        for(size_t k = 0; k < t->fields[i].key_len; k++) h = keyed_hash_step(h, (unsigned char)t->fields[i].key[k]);
 
-        if(strcmp(label, "MemTotal:") == 0) mem_total = data;
+        unsigned slot = keyed_slot(h, t->mask);
 
-        if(strcmp(label, "MemAvailable:") == 0) mem_available = data;
+        if(t->slots[slot] != -1) return -1;     // field list changed, a new seed has to be picked
 
-        if(mem_total != -1 && mem_available != -1) break;
+        t->slots[slot] = (signed char)i;
 
     }
 
-    fclose(f);
+    t->built = 1;
+
+    return 0;
+
+}
+
+
+static int read_keyed_file(const char* path, int* fd){
+
+    if(*fd < 0){
+
+        *fd = open(path, O_RDONLY | O_CLOEXEC);
 
+        if(*fd < 0) return -1;
 
-    *total_kb_out     = mem_total;
-    *available_kb_out = mem_available;
+    }
+
+    ssize_t n = pread(*fd, keyed_buf, sizeof(keyed_buf) - 1, 0);
+
+    if(n <= 0) return -1;
+
+    keyed_buf[n] = '\0';
+
+    return 0;
+
+}
+
+
+// "Key:   123 kB" (meminfo) and "key 123" (vmstat) lines, one pass over the buffer
+static int parse_keyed(KeyedTable* t, void* base){
+
+    if(!t->built && keyed_table_build(t) != 0) return -1;
+
+    const char* p = keyed_buf;
+
+    while(*p){
+
+        const char* key = p;
+        uint32_t h = t->seed;
+
+        while(*p && *p != ':' && *p != ' ' && *p != '\n'){
+
+            h = keyed_hash_step(h, (unsigned char)*p);
+            p++;
+
+        }
+
+        size_t len = (size_t)(p - key);
+        int idx = t->slots[keyed_slot(h, t->mask)];
+
+        if(idx >= 0 && t->fields[idx].key_len == len && memcmp(t->fields[idx].key, key, len) == 0){
+
+            while(*p == ':' || *p == ' ') p++;
+
+            unsigned long long v = 0;
+
+            while(*p >= '0' && *p <= '9') v = v * 10u + (unsigned long long)(*p++ - '0');
+
+            char* slot = (char*)base + t->fields[idx].offset;
+
+            if(t->wide) *(unsigned long long*)slot = v;
+            else        *(long*)slot = (long)v;
+
+        }
+
+        while(*p && *p != '\n') p++;
+
+        if(*p == '\n') p++;
+
+    }
+
+    return 0;
+
+}
+
+
+static double counter_rate(unsigned long long now, unsigned long long before, double dt){
+
+    if(dt <= 0.0 || now < before) return 0.0;
+
+    return (double)(now - before) / dt;
+
+}
+
+
+static int read_memory_info(HardwareStats* out){
+
+    out->mem_total_kb     = -1;
+    out->mem_available_kb = -1;
+
+    if(read_keyed_file("/proc/meminfo", &meminfo_fd) != 0) return -1;
+
+    if(parse_keyed(&meminfo_table, out) != 0) return -1;
+
+    if(out->mem_total_kb == -1 || out->mem_available_kb == -1) return -1;
+
+    out->mem_used_percent = out->mem_total_kb > 0
+        ? 100.0 * (double)(out->mem_total_kb - out->mem_available_kb) / (double)out->mem_total_kb : 0.0;
+
+
+    VmCounters vm;
+    memset(&vm, 0, sizeof(vm));
+
+    if(read_keyed_file("/proc/vmstat", &vmstat_fd) != 0 || parse_keyed(&vmstat_table, &vm) != 0) return 0;  // meminfo alone is still useful
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    double now = (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+    double dt  = (previous_vm_time > 0.0) ? now - previous_vm_time : 0.0;
+
+    out->pgfault_per_s    = counter_rate(vm.pgfault,    previous_vm.pgfault,    dt);
+    out->pgmajfault_per_s = counter_rate(vm.pgmajfault, previous_vm.pgmajfault, dt);
+    out->pswpin_per_s     = counter_rate(vm.pswpin,     previous_vm.pswpin,     dt);
+    out->pswpout_per_s    = counter_rate(vm.pswpout,    previous_vm.pswpout,    dt);
+    out->pgpgin_per_s     = counter_rate(vm.pgpgin,     previous_vm.pgpgin,     dt);
+    out->pgpgout_per_s    = counter_rate(vm.pgpgout,    previous_vm.pgpgout,    dt);
+    out->pgsteal_per_s    = counter_rate(vm.pgsteal_kswapd + vm.pgsteal_direct,
+                                         previous_vm.pgsteal_kswapd + previous_vm.pgsteal_direct, dt);
+    out->allocstall_per_s = counter_rate(vm.allocstall_normal, previous_vm.allocstall_normal, dt);
+    out->oom_kill_total   = vm.oom_kill;
+
+    previous_vm      = vm;
+    previous_vm_time = now;
 
     return 0;
 
@@ -202,19 +500,414 @@ static double read_cpu_tempurature_in_celcius(){
 }
 
 
-int read_system_stats(HardwareStats *out){
+static void read_network_top(HardwareStats* out){
 
-    if(!out) return -1;
-    
-    out->cpu_usage_percent = calc_cpu_usage_time();
+    NetIfRates top;
+    size_t count = 0;
+
+    if(net_dev_sample(&top, &count) != 0){
+
+        memset(&top, 0, sizeof(top));  // no /proc/net/dev (or unreadable), page shows empty iface
+        count = 0;
+
+    }
+
+    memcpy(out->net_iface, top.name, sizeof(out->net_iface));
+    out->net_iface_count      = (unsigned)count;
+    out->net_rx_bytes_per_s   = top.rx_bytes_per_s;
+    out->net_tx_bytes_per_s   = top.tx_bytes_per_s;
+    out->net_rx_packets_per_s = top.rx_packets_per_s;
+    out->net_tx_packets_per_s = top.tx_packets_per_s;
+    out->net_rx_errs_per_s    = top.rx_errs_per_s;
+    out->net_tx_errs_per_s    = top.tx_errs_per_s;
+    out->net_rx_drop_per_s    = top.rx_drop_per_s;
+    out->net_tx_drop_per_s    = top.tx_drop_per_s;
+
+}
+
+
+static void read_top_processes(HardwareStats* out){
+
+    size_t total = 0;
+    int n = proc_top_sample(out->top_procs, PROC_TOP_N, &total);
+
+    if(n < 0){
+
+        out->top_proc_count = 0;
+        out->proc_count     = 0;
+        return;
+
+    }
+
+    out->top_proc_count = (unsigned)n;
+    out->proc_count     = (unsigned)total;
+
+}
+
+
+static void read_cgroup_top(HardwareStats* out){
+
+    size_t count = 0;
+
+    if(cgroup_sample(&out->cgroup_top, &count) != 0){
+
+        memset(&out->cgroup_top, 0, sizeof(out->cgroup_top));  // no cgroup v2 mounted
+        count = 0;
+
+    }
 
-    if(read_memory_info(&out->mem_total_kb, &out->mem_available_kb) != 0) return -1;
+    out->cgroup_count = (unsigned)count;
 
-    if(read_load_average(&out->load1, &out->load5, &out->load15) != 0) return -1;
+}
+
+
+static int read_cpu(HardwareStats* out){
+
+    out->cpu_usage_percent = calc_cpu_usage_time(out);
+    return 0;
+
+}
+
+
+static int read_loadavg(HardwareStats* out){
+
+    return read_load_average(&out->load1, &out->load5, &out->load15);
+
+}
 
-    if(read_uptime(&out->uptime_seconds) != 0) return -1;
+
+static int read_uptime_stat(HardwareStats* out){
+
+    return read_uptime(&out->uptime_seconds);
+
+}
+
+
+static int read_temp(HardwareStats* out){
 
     out->cpu_temp_c = read_cpu_tempurature_in_celcius();
+    return 0;
+
+}
+
+
+static int read_net(HardwareStats* out){
+
+    read_network_top(out);
+    return 0;
+
+}
+
+
+static int read_procs(HardwareStats* out){
+
+    read_top_processes(out);
+    return 0;
+
+}
+
+
+static int read_psi(HardwareStats* out){
+
+    if(psi_read_all(out->psi) != 0) memset(out->psi, 0, sizeof(out->psi));  // kernel without PSI
+    return 0;
+
+}
+
+
+static int read_cgroups(HardwareStats* out){
+
+    read_cgroup_top(out);
+    return 0;
+
+}
+
+
+static int read_irq(HardwareStats* out){
+
+    if(interrupts_sample(&out->irq) != 0) memset(&out->irq, 0, sizeof(out->irq));
+    return 0;
+
+}
+
+
+// headline value per collector: how fast it changes decides how often it is read
+static double signal_cpu(const HardwareStats* s)     { return s->cpu_usage_percent; }
+static double signal_memory(const HardwareStats* s)  { return s->mem_used_percent + s->pgmajfault_per_s + s->pswpout_per_s; }
+static double signal_loadavg(const HardwareStats* s) { return s->load1; }
+static double signal_uptime(const HardwareStats* s)  { (void)s; return 0.0; }
+static double signal_temp(const HardwareStats* s)    { return s->cpu_temp_c; }
+static double signal_net(const HardwareStats* s)     { return s->net_rx_bytes_per_s + s->net_tx_bytes_per_s; }
+static double signal_procs(const HardwareStats* s)   { return s->top_proc_count ? s->top_procs[0].cpu_percent : 0.0; }
+static double signal_cgroups(const HardwareStats* s) { return s->cgroup_top.cpu_percent; }
+static double signal_irq(const HardwareStats* s)     { return s->irq.irq_total_per_s + s->irq.softirq_total_per_s; }
+
+static double signal_psi(const HardwareStats* s){
+
+    return s->psi[PSI_CPU].some_avg10 + s->psi[PSI_MEMORY].some_avg10 + s->psi[PSI_IO].some_avg10;
+
+}
+
+
+typedef struct {
+
+    DiagStage stage;
+    int (*read)(HardwareStats* out);        // -1 only for sources the struct cannot do without
+    double (*signal)(const HardwareStats* s);
+    SchedulerConfig sched;                  // name, min/max ms, threshold, floor, cpu budget
+    int id;
+
+}Collector;
+
+static Collector collectors[] = {
+    {DIAG_CPU,     read_cpu,         signal_cpu,     {"cpu",     250,  2000, 0.40, 25.0,  0.0 }, -1},
+    {DIAG_MEMORY,  read_memory_info, signal_memory,  {"memory",  250,  4000, 0.05, 5.0,   0.0 }, -1},
+    {DIAG_LOADAVG, read_loadavg,     signal_loadavg, {"loadavg", 1000, 5000, 0.10, 0.5,   0.0 }, -1},
+    {DIAG_UPTIME,  read_uptime_stat, signal_uptime,  {"uptime",  1000, 1000, 1.00, 1.0,   0.0 }, -1},
+    {DIAG_TEMP,    read_temp,        signal_temp,    {"temp",    500,  5000, 0.03, 10.0,  0.0 }, -1},
+    {DIAG_NET,     read_net,         signal_net,     {"net",     100,  2000, 0.50, 1e4,   0.0 }, -1},
+    {DIAG_PROCS,   read_procs,       signal_procs,   {"procs",   1000, 8000, 0.30, 5.0,   0.01}, -1},
+    {DIAG_PSI,     read_psi,         signal_psi,     {"psi",     100,  2000, 0.20, 1.0,   0.0 }, -1},
+    {DIAG_CGROUP,  read_cgroups,     signal_cgroups, {"cgroup",  1000, 8000, 0.30, 5.0,   0.01}, -1},
+    {DIAG_IRQ,     read_irq,         signal_irq,     {"irq",     250,  4000, 0.50, 1000.0, 0.0}, -1},
+};
+
+#define COLLECTOR_COUNT (sizeof(collectors) / sizeof(collectors[0]))
+
+static int collectors_scheduled = 0;
+
+
+// the estimators take one sample per second whichever collectors woke up, so
+// EST_RING_SLOTS spans the 5 min window and quantiles weigh time, not wakeups
+#define ESTIMATOR_PERIOD_NS 1000000000ULL
+
+static uint64_t estimators_last_ns = 0;
+
+
+static int update_estimators(const HardwareStats* s, uint64_t now_ns){
+
+    if(estimators_last_ns && now_ns - estimators_last_ns < ESTIMATOR_PERIOD_NS) return 0;
+
+    // keep to the 1 s grid unless a stall put us more than a period behind
+    if(estimators_last_ns && now_ns - estimators_last_ns < 2 * ESTIMATOR_PERIOD_NS) estimators_last_ns += ESTIMATOR_PERIOD_NS;
+    else estimators_last_ns = now_ns;
+
+    estimators_update(s, now_ns);
+
+    return 1;
+}
+
+
+// one history slot per second; the fields are the dashboard's TREND rows
+#define HISTORY_PERIOD_NS   1000000000ULL
+#define HISTORY_REPLAY_MS   (5ULL * 60ULL * 1000ULL)    // longest estimator window
+
+static const char* const history_fields[HISTORY_VALUES] = {
+    "cpu", "mem.used_percent", "load1", "net.rx_bytes", "net.tx_bytes",
+    "psi.cpu.some10", "psi.memory.some10", "psi.io.some10",
+};
+
+static int      history_index[HISTORY_VALUES];
+static uint64_t history_last_ns = 0;
+
+
+static uint64_t unix_now_ms(void){
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+
+}
+
+
+static void record_history(const HardwareStats* s, uint64_t now_ns){
+
+    if(!history_is_open() || (history_last_ns && now_ns - history_last_ns < HISTORY_PERIOD_NS)) return;
+
+    history_last_ns = now_ns;
+
+    size_t nfields;
+    const StatField* fields = stat_fields(&nfields);
+
+    HistorySample h;
+    memset(&h, 0, sizeof(h));
+    h.unix_ms = unix_now_ms();
+
+    if(previous_initialized){
+
+        h.cpu_total = previous_total;
+        h.cpu_idle  = previous_idle;
+
+    }
+
+    for(size_t i = 0; i < HISTORY_VALUES; i++){
+
+        if(history_index[i] >= 0) h.values[i] = (float)stat_field_value(&fields[history_index[i]], s);
+
+    }
+
+    history_append(&h);
+}
+
+
+static int read_all_collectors(HardwareStats* out){
+
+    uint64_t t = diag_now_ns();
+
+    for(size_t i = 0; i < COLLECTOR_COUNT; i++){
+
+        if(collectors[i].read(out) != 0) return -1;
+        t = diag_lap(collectors[i].stage, t);
+
+    }
+
+    if(update_estimators(out, t)) t = diag_lap(DIAG_ESTIMATORS, t);
+
+    record_history(out, t);
+    fleet_sender_tick(out, t);
 
     return 0;
-}
\ No newline at end of file
+}
+
+
+int read_system_stats(HardwareStats *out){
+
+    if(!out) return -1;
+
+    uint64_t start = diag_now_ns();
+    perf_counters_begin();
+
+    int rc = read_all_collectors(out);
+
+    perf_counters_end();
+    diag_lap(DIAG_SAMPLE, start);
+
+    return rc;
+}
+
+
+int read_due_stats(HardwareStats* out, uint64_t now_ns){
+
+    if(!out) return -1;
+
+    if(!collectors_scheduled){
+
+        for(size_t i = 0; i < COLLECTOR_COUNT; i++) collectors[i].id = scheduler_add(&collectors[i].sched, now_ns);
+        collectors_scheduled = 1;
+
+    }
+
+    int due[SCHEDULER_MAX_SOURCES];
+    size_t n = scheduler_pop_due(now_ns, due, SCHEDULER_MAX_SOURCES);
+
+    if(n == 0) return 0;
+
+    uint64_t start = diag_now_ns();
+    perf_counters_begin();
+
+    int rc = 0;
+    uint64_t t = start;
+
+    for(size_t k = 0; k < n; k++){
+
+        Collector* c = NULL;
+
+        for(size_t i = 0; i < COLLECTOR_COUNT; i++) if(collectors[i].id == due[k]) c = &collectors[i];
+
+        if(!c) continue;
+
+        if(c->read(out) != 0) rc = -1;
+
+        uint64_t done = diag_lap(c->stage, t);
+        scheduler_report(c->id, now_ns, c->signal(out), done - t);
+        t = done;
+
+    }
+
+    if(update_estimators(out, t)) t = diag_lap(DIAG_ESTIMATORS, t);
+
+    record_history(out, t);
+    fleet_sender_tick(out, t);
+
+    perf_counters_end();
+    diag_lap(DIAG_SAMPLE, start);
+
+    return rc < 0 ? -1 : (int)n;
+}
+
+
+uint64_t read_due_stats_deadline(void){
+
+    return scheduler_next_deadline();
+
+}
+
+
+int stats_history_open(const char* path){
+
+    if(!path || history_open(path) != 0) return -1;
+
+    size_t nfields;
+    const StatField* fields = stat_fields(&nfields);
+
+    static unsigned char present[STAT_FIELD_MAX];
+    memset(present, 0, sizeof(present));
+
+    for(size_t i = 0; i < HISTORY_VALUES; i++){
+
+        history_index[i] = stat_field_index(history_fields[i]);
+
+        if(history_index[i] >= 0) present[history_index[i]] = 1;
+
+    }
+
+    static HistorySample recovered[HISTORY_SLOTS];
+    size_t n = history_recovered(recovered, HISTORY_SLOTS, HISTORY_REPLAY_MS);
+
+    if(n == 0) return 0;
+
+    // replay onto the monotonic clock the estimators run on; anything older
+    // than CLOCK_MONOTONIC's zero (before this boot) cannot be placed
+    static HardwareStats replay;
+    memset(&replay, 0, sizeof(replay));
+
+    uint64_t now_unix = unix_now_ms();
+    uint64_t now_mono = diag_now_ns();
+
+    for(size_t k = 0; k < n; k++){
+
+        uint64_t age_ns = (now_unix - recovered[k].unix_ms) * 1000000ULL;
+
+        if(age_ns >= now_mono) continue;
+
+        for(size_t i = 0; i < HISTORY_VALUES; i++){
+
+            if(history_index[i] >= 0 && fields[history_index[i]].type == STAT_DOUBLE)
+                *(double*)((char*)&replay + fields[history_index[i]].offset) = recovered[k].values[i];
+
+        }
+
+        estimators_update_partial(&replay, present, now_mono - age_ns);
+
+    }
+
+    // /proc/stat counters restart at boot; only the same boot can continue them
+    const HistorySample* last = &recovered[n - 1];
+
+    if(history_same_boot() && last->cpu_total != 0){
+
+        previous_total       = last->cpu_total;
+        previous_idle        = last->cpu_idle;
+        previous_initialized = 1;
+
+    }
+
+    return (int)n;
+}
+
+
+void stats_history_close(void){
+
+    history_close();
+
+}
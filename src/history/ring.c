@@ -0,0 +1,226 @@
+#define _DEFAULT_SOURCE
+#include "history/ring.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/* =======================
+ * Internal structures
+ * ======================= */
+
+#define HISTORY_MAGIC    "HWHIST\0\1"
+#define HISTORY_VERSION  1
+#define BOOT_ID_LEN      36
+
+typedef struct HistoryHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t slot_size;
+    uint32_t slot_count;
+    uint32_t generation;            // bumped by every writer that opens the ring
+    char     boot_id[BOOT_ID_LEN];  // boot that wrote the newest slot
+    uint32_t checksum;
+} HistoryHeader;
+
+_Static_assert(sizeof(HistoryHeader) == HISTORY_SLOT_SIZE, "history header must fill one slot");
+_Static_assert(sizeof(HistorySample) == HISTORY_SLOT_SIZE, "history sample must fill one cache line");
+
+#define HISTORY_FILE_SIZE ((size_t)HISTORY_SLOT_SIZE * (HISTORY_SLOTS + 1))
+
+static int            g_fd = -1;
+static uint8_t*       g_map = NULL;
+static HistoryHeader* g_header = NULL;
+static HistorySample* g_slots = NULL;
+
+static uint32_t g_next_seq = 1;
+static uint32_t g_newest = 0;       // newest valid recovered seq, 0 if none
+static int      g_same_boot = 0;
+static char     g_boot_id[BOOT_ID_LEN];
+static int      g_header_stamped = 0;
+
+/* =======================
+ * Helpers
+ * ======================= */
+
+// FNV-1a; the slot is tiny and this runs at most once a second
+static uint32_t checksum(const void* p, size_t len) {
+    const uint8_t* b = p;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) h = (h ^ b[i]) * 16777619u;
+    return h;
+}
+
+static uint32_t header_checksum(const HistoryHeader* h) {
+    HistoryHeader tmp = *h;
+    tmp.checksum = 0;
+    return checksum(&tmp, sizeof(tmp));
+}
+
+static uint32_t sample_checksum(const HistorySample* s) {
+    HistorySample tmp = *s;
+    tmp.checksum = 0;
+    return checksum(&tmp, sizeof(tmp));
+}
+
+static int slot_valid(const HistorySample* s, uint32_t seq) {
+    return s->seq == seq && seq != 0 && s->checksum == sample_checksum(s);
+}
+
+static void read_boot_id(char out[BOOT_ID_LEN]) {
+    memset(out, 0, BOOT_ID_LEN);
+    FILE* f = fopen("/proc/sys/kernel/random/boot_id", "r");
+    if (!f) return;
+    char buf[64];
+    if (fgets(buf, sizeof(buf), f)) memcpy(out, buf, strnlen(buf, BOOT_ID_LEN));
+    fclose(f);
+}
+
+static uint64_t unix_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000ull + (uint64_t)ts.tv_nsec / 1000000ull;
+}
+
+static void write_header(int stamp_boot) {
+    HistoryHeader h = *g_header;
+    memcpy(h.magic, HISTORY_MAGIC, sizeof(h.magic));
+    h.version = HISTORY_VERSION;
+    h.slot_size = HISTORY_SLOT_SIZE;
+    h.slot_count = HISTORY_SLOTS;
+    if (stamp_boot) memcpy(h.boot_id, g_boot_id, BOOT_ID_LEN);
+    else h.generation++;
+    h.checksum = header_checksum(&h);
+    *g_header = h;
+}
+
+static int header_valid(const HistoryHeader* h) {
+    return !memcmp(h->magic, HISTORY_MAGIC, sizeof(h->magic)) &&
+           h->version == HISTORY_VERSION &&
+           h->slot_size == HISTORY_SLOT_SIZE &&
+           h->slot_count == HISTORY_SLOTS &&
+           h->checksum == header_checksum(h);
+}
+
+// newest slot that passes its checksum; older slots are walked from there
+static uint32_t find_newest(void) {
+    uint32_t newest = 0;
+    for (unsigned i = 0; i < HISTORY_SLOTS; i++) {
+        const HistorySample* s = &g_slots[i];
+        if (s->seq % HISTORY_SLOTS == i && s->seq > newest && slot_valid(s, s->seq)) newest = s->seq;
+    }
+    return newest;
+}
+
+/* =======================
+ * Public API
+ * ======================= */
+
+int history_open(const char* path) {
+    if (g_map) return 0;
+
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) return -1;
+
+    // one writer per file; a second monitor would interleave sequences
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) goto fail;
+
+    int fresh = (size_t)st.st_size != HISTORY_FILE_SIZE;
+    if (fresh && (ftruncate(fd, 0) != 0 || ftruncate(fd, (off_t)HISTORY_FILE_SIZE) != 0)) goto fail;
+
+    void* map = mmap(NULL, HISTORY_FILE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) goto fail;
+
+    g_fd = fd;
+    g_map = map;
+    g_header = (HistoryHeader*)map;
+    g_slots = (HistorySample*)(g_map + HISTORY_SLOT_SIZE);
+
+    read_boot_id(g_boot_id);
+
+    if (fresh || !header_valid(g_header)) {
+        memset(g_map, 0, HISTORY_FILE_SIZE);
+        g_newest = 0;
+        g_same_boot = 0;
+    } else {
+        g_newest = find_newest();
+        g_same_boot = g_boot_id[0] && !memcmp(g_boot_id, g_header->boot_id, BOOT_ID_LEN);
+    }
+    g_next_seq = g_newest + 1;
+
+    // the boot id follows the first sample, so it always names the boot
+    // that wrote the newest slot
+    write_header(0);
+    g_header_stamped = 0;
+    return 0;
+
+fail:
+    close(fd);
+    return -1;
+}
+
+int history_is_open(void) {
+    return g_map != NULL;
+}
+
+int history_same_boot(void) {
+    return g_map && g_same_boot;
+}
+
+size_t history_recovered(HistorySample* out, size_t max, uint64_t max_age_ms) {
+    if (!g_map || !g_newest || !max) return 0;
+
+    uint64_t now = unix_now_ms();
+    size_t n = 0;
+
+    // walk back while each older seq is intact, then reverse into out
+    for (uint32_t seq = g_newest; seq != 0 && n < max && n < HISTORY_SLOTS; seq--) {
+        const HistorySample* s = &g_slots[seq % HISTORY_SLOTS];
+        if (!slot_valid(s, seq)) break;
+        if (s->unix_ms > now || now - s->unix_ms > max_age_ms) break;
+        out[n++] = *s;
+    }
+    for (size_t i = 0; i < n / 2; i++) {
+        HistorySample tmp = out[i];
+        out[i] = out[n - 1 - i];
+        out[n - 1 - i] = tmp;
+    }
+    return n;
+}
+
+void history_append(HistorySample* s) {
+    if (!g_map) return;
+
+    if (!g_header_stamped) {
+        write_header(1);
+        g_header_stamped = 1;
+    }
+
+    s->seq = g_next_seq++;
+    if (g_next_seq == 0) g_next_seq = 1;   // 136 years at 1 Hz, but never write seq 0
+    s->checksum = sample_checksum(s);
+    g_slots[s->seq % HISTORY_SLOTS] = *s;
+}
+
+void history_close(void) {
+    if (!g_map) return;
+    munmap(g_map, HISTORY_FILE_SIZE);
+    close(g_fd);
+    g_map = NULL;
+    g_header = NULL;
+    g_slots = NULL;
+    g_fd = -1;
+    g_newest = 0;
+    g_same_boot = 0;
+}
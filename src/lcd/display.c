@@ -0,0 +1,250 @@
+#define _DEFAULT_SOURCE
+#include "lcd/display.h"
+#include "pins.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* =======================
+ * Internal structures
+ * ======================= */
+
+#define DDRAM_SIZE      0x80
+#define EXEC_US_MIN     37          // datasheet, at 270 kHz
+#define SPIN_NS         60000       // nanosleep overshoots by about this much: shorter waits spin
+
+typedef struct {
+    unsigned cols, rows;
+    unsigned across, stride;                // tile layout: tiles per row band, columns per tile
+    uint64_t exec_ns;
+    uint64_t ready_ns;                      // busy with the last byte until then
+    int      addr;                          // the panel's DDRAM address counter
+    unsigned dirty;                         // cells where shadow != target
+    uint8_t  shadow[DISPLAY_MAX_CELLS];     // on the glass
+    uint8_t  target[DISPLAY_MAX_CELLS];     // wanted
+    uint8_t  cell_addr[DISPLAY_MAX_CELLS];
+    int8_t   addr_cell[DDRAM_SIZE];         // -1: not visible
+} Panel;
+
+struct Display {
+    Hd44780* bus;
+    Panel    panel[DISPLAY_MAX_PANELS];
+    unsigned count;
+    unsigned first;                         // round-robin start of the next pump pass
+    unsigned tiles;
+};
+
+/* =======================
+ * Helpers
+ * ======================= */
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_ns(uint64_t ns) {
+    struct timespec ts = { (time_t)(ns / 1000000000ULL), (long)(ns % 1000000000ULL) };
+    nanosleep(&ts, NULL);
+}
+
+// two-line mode: rows 2 and 3 of a four-line panel continue rows 0 and 1
+static void panel_setup(Panel* p, const DisplayPanelConfig* c) {
+    memset(p, 0, sizeof(*p));
+    p->cols = c->cols;
+    p->rows = c->rows;
+    p->across = c->cols / LCD_COLS;
+    p->stride = c->cols / p->across;
+    p->exec_ns = c->exec_us ? (uint64_t)c->exec_us * 1000ULL : HD44780_EXEC_NS;
+
+    memset(p->addr_cell, -1, sizeof(p->addr_cell));
+    for (unsigned r = 0; r < p->rows; r++) {
+        for (unsigned col = 0; col < p->cols; col++) {
+            unsigned cell = r * p->cols + col;
+            unsigned addr = ((r & 1) ? 0x40 : 0x00) + ((r & 2) ? p->cols : 0) + col;
+            p->cell_addr[cell] = (uint8_t)addr;
+            p->addr_cell[addr] = (int8_t)cell;
+        }
+    }
+
+    // hd44780_init() leaves every panel cleared with the address counter at 0
+    memset(p->shadow, ' ', sizeof(p->shadow));
+    memset(p->target, ' ', sizeof(p->target));
+    p->addr = 0;
+}
+
+static int next_addr(int addr) {
+    if (addr == 0x27) return 0x40;
+    if (addr == 0x67) return 0x00;
+    return addr + 1;
+}
+
+/*
+ * One byte of the panel's queue: the cell under the address counter if
+ * it is dirty (runs cost a byte per character), else a jump to the next
+ * dirty cell.
+ */
+static int panel_step(Hd44780* bus, unsigned idx, Panel* p) {
+    unsigned ncells = p->rows * p->cols;
+    int cell = p->addr_cell[p->addr & (DDRAM_SIZE - 1)];
+
+    if (cell >= 0 && p->shadow[cell] != p->target[cell]) {
+        if (hd44780_send(bus, idx, 1, p->target[cell]) != 0) return -1;
+        p->shadow[cell] = p->target[cell];
+        p->dirty--;
+        p->addr = next_addr(p->addr);
+    } else {
+        unsigned from = cell >= 0 ? (unsigned)cell + 1 : 0;
+        unsigned next = from;
+        for (unsigned k = 0; k < ncells; k++) {
+            next = (from + k) % ncells;
+            if (p->shadow[next] != p->target[next]) break;
+        }
+        if (hd44780_send(bus, idx, 0, (uint8_t)(HD44780_CMD_DDRAM | p->cell_addr[next])) != 0) return -1;
+        p->addr = p->cell_addr[next];
+    }
+
+    p->ready_ns = mono_ns() + p->exec_ns;
+    return 0;
+}
+
+/* =======================
+ * Public API
+ * ======================= */
+
+int display_parse_panel(const char* spec, DisplayPanelConfig* out) {
+    if (!spec || !out) return -1;
+
+    char* end;
+    unsigned long cols = strtoul(spec, &end, 10);
+    if (end == spec || *end != 'x') return -1;
+    const char* p = end + 1;
+    unsigned long rows = strtoul(p, &end, 10);
+    if (end == p) return -1;
+
+    unsigned long e_pin = PIN_LCD_E, exec_us = 0;
+    if (*end == '@') {
+        p = end + 1;
+        e_pin = strtoul(p, &end, 10);
+        if (end == p) return -1;
+    }
+    if (*end == '/') {
+        p = end + 1;
+        exec_us = strtoul(p, &end, 10);
+        if (end == p || exec_us < EXEC_US_MIN || exec_us > 100000) return -1;
+    }
+    if (*end != '\0') return -1;
+
+    if ((rows != 2 && rows != 4) || cols < LCD_COLS || cols > 40 || cols * rows > DISPLAY_MAX_CELLS) return -1;
+
+    out->cols = (unsigned)cols;
+    out->rows = (unsigned)rows;
+    out->e_pin = (unsigned)e_pin;
+    out->exec_us = (unsigned)exec_us;
+    return 0;
+}
+
+int display_open(Display** out, const DisplayPanelConfig* panels, unsigned n) {
+    if (!out || !panels || n == 0 || n > DISPLAY_MAX_PANELS) return -1;
+
+    unsigned e_pins[DISPLAY_MAX_PANELS];
+    unsigned slowest_us = 0;
+    for (unsigned i = 0; i < n; i++) {
+        e_pins[i] = panels[i].e_pin;
+        if (panels[i].exec_us > slowest_us) slowest_us = panels[i].exec_us;
+        for (unsigned j = 0; j < i; j++)
+            if (e_pins[j] == e_pins[i]) return -1;
+    }
+
+    Display* d = calloc(1, sizeof(*d));
+    if (!d) return -1;
+
+    if (hd44780_init(&d->bus, e_pins, n, (uint64_t)slowest_us * 1000ULL) != 0) {
+        free(d);
+        return -1;
+    }
+
+    d->count = n;
+    for (unsigned i = 0; i < n; i++) {
+        panel_setup(&d->panel[i], &panels[i]);
+        unsigned tiles = d->panel[i].across * (d->panel[i].rows / 2);
+        if (tiles > d->tiles) d->tiles = tiles;
+    }
+    if (d->tiles > DISPLAY_MAX_TILES) d->tiles = DISPLAY_MAX_TILES;
+
+    *out = d;
+    return 0;
+}
+
+void display_close(Display* d) {
+    if (!d) return;
+    hd44780_deinit(d->bus);
+    free(d);
+}
+
+unsigned display_tiles(const Display* d) {
+    return d ? d->tiles : 0;
+}
+
+void display_set_frame(Display* d, const PageTile* tiles, unsigned ntiles) {
+    if (!d) return;
+    if (!tiles) ntiles = 0;
+
+    for (unsigned i = 0; i < d->count; i++) {
+        Panel* p = &d->panel[i];
+        p->dirty = 0;
+        for (unsigned r = 0; r < p->rows; r++) {
+            for (unsigned col = 0; col < p->cols; col++) {
+                unsigned tile = (r / 2) * p->across + col / p->stride;
+                unsigned tc = col % p->stride;
+                char ch = ' ';
+                if (tile < ntiles && tc < LCD_COLS && tiles[tile].line[r & 1][tc]) ch = tiles[tile].line[r & 1][tc];
+
+                unsigned cell = r * p->cols + col;
+                p->target[cell] = (uint8_t)ch;
+                if (p->shadow[cell] != p->target[cell]) p->dirty++;
+            }
+        }
+    }
+}
+
+void display_blank(Display* d) {
+    display_set_frame(d, NULL, 0);
+}
+
+int display_pump(Display* d, uint64_t deadline_ns) {
+    if (!d) return -1;
+
+    for (;;) {
+        uint64_t now = mono_ns();
+        uint64_t soonest = UINT64_MAX;
+        int pending = 0, sent = 0;
+
+        // one byte per ready panel per pass, starting with a different panel each pass
+        for (unsigned k = 0; k < d->count; k++) {
+            unsigned i = (d->first + k) % d->count;
+            Panel* p = &d->panel[i];
+            if (!p->dirty) continue;
+            pending = 1;
+
+            if (p->ready_ns > now) {
+                if (p->ready_ns < soonest) soonest = p->ready_ns;
+                continue;
+            }
+            if (panel_step(d->bus, i, p) != 0) return -1;
+            sent = 1;
+            now = mono_ns();
+        }
+        d->first = (d->first + 1) % d->count;
+
+        if (!pending) return 1;
+        if (now >= deadline_ns) return 0;
+        if (sent) continue;
+
+        // everyone is busy executing: wait for the first to finish
+        uint64_t until = soonest < deadline_ns ? soonest : deadline_ns;
+        if (until > now + SPIN_NS) sleep_ns(until - now - SPIN_NS);
+    }
+}
@@ -11,7 +11,9 @@ struct Hd44780 {
     struct gpiod_chip* chip;
     struct gpiod_line_request* req;
 
-    unsigned rs, e, d4, d5, d6, d7;
+    unsigned rs, d4, d5, d6, d7;
+    unsigned e[HD44780_MAX_PANELS];
+    unsigned panels;
 };
 
 static void sleep_us(long us) {
@@ -25,45 +27,43 @@ static int setv(Hd44780* lcd, unsigned offset, int v) {
     return gpiod_line_request_set_value(lcd->req, offset, v); // v2 API
 }
 
-static int write4(Hd44780* lcd, int nibble) {
-    // nibble b3..b0 -> D7..D4
-    if (setv(lcd, lcd->d4, (nibble >> 0) & 1) != 0) return -1;
-    if (setv(lcd, lcd->d5, (nibble >> 1) & 1) != 0) return -1;
-    if (setv(lcd, lcd->d6, (nibble >> 2) & 1) != 0) return -1;
-    if (setv(lcd, lcd->d7, (nibble >> 3) & 1) != 0) return -1;
-
-    // E pulse
-    if (setv(lcd, lcd->e, 1) != 0) return -1;
-    sleep_us(1);
-    if (setv(lcd, lcd->e, 0) != 0) return -1;
-
-    // komut/data yazım süresi
-    sleep_us(40);
+static int write4(Hd44780* lcd, unsigned panel_mask, int rs, int nibble) {
+    // RS + nibble b3..b0 -> D7..D4 in one request, before E rises
+    unsigned offsets[5] = { lcd->d4, lcd->d5, lcd->d6, lcd->d7, lcd->rs };
+    enum gpiod_line_value values[5];
+    for (int i = 0; i < 4; i++) values[i] = ((nibble >> i) & 1) ? GPIOD_LINE_VALUE_ACTIVE : GPIOD_LINE_VALUE_INACTIVE;
+    values[4] = rs ? GPIOD_LINE_VALUE_ACTIVE : GPIOD_LINE_VALUE_INACTIVE;
+    if (gpiod_line_request_set_values_subset(lcd->req, 5, offsets, values) != 0) return -1;
+
+    // E pulse; one line change is already longer than the 450 ns the panel needs
+    for (unsigned p = 0; p < lcd->panels; p++) {
+        if (!(panel_mask & (1u << p))) continue;
+        if (setv(lcd, lcd->e[p], 1) != 0) return -1;
+        if (setv(lcd, lcd->e[p], 0) != 0) return -1;
+    }
     return 0;
 }
 
-static int send_byte(Hd44780* lcd, int rs, int byte) {
-    if (setv(lcd, lcd->rs, rs) != 0) return -1;
-    if (write4(lcd, (byte >> 4) & 0x0F) != 0) return -1;
-    if (write4(lcd, (byte >> 0) & 0x0F) != 0) return -1;
+// no wait between the two nibbles of a byte, only after the whole byte
+static int write8(Hd44780* lcd, unsigned panel_mask, int rs, int byte) {
+    if (write4(lcd, panel_mask, rs, (byte >> 4) & 0x0F) != 0) return -1;
+    if (write4(lcd, panel_mask, rs, (byte >> 0) & 0x0F) != 0) return -1;
     return 0;
 }
 
-static int cmd(Hd44780* lcd, int c) { return send_byte(lcd, 0, c); }
-static int dat(Hd44780* lcd, int d) { return send_byte(lcd, 1, d); }
-
-int hd44780_init(Hd44780** out) {
-    if (!out) return -1;
+int hd44780_init(Hd44780** out, const unsigned* e_pins, unsigned panels, uint64_t exec_ns) {
+    if (!out || !e_pins || panels == 0 || panels > HD44780_MAX_PANELS) return -1;
 
     Hd44780* lcd = calloc(1, sizeof(*lcd));
     if (!lcd) return -1;
 
     lcd->rs = PIN_LCD_RS;
-    lcd->e  = PIN_LCD_E;
     lcd->d4 = PIN_LCD_D4;
     lcd->d5 = PIN_LCD_D5;
     lcd->d6 = PIN_LCD_D6;
     lcd->d7 = PIN_LCD_D7;
+    lcd->panels = panels;
+    memcpy(lcd->e, e_pins, panels * sizeof(*e_pins));
 
     lcd->chip = gpiod_chip_open(GPIO_CHIP_PATH);
     if (!lcd->chip) { free(lcd); return -1; }
@@ -76,9 +76,11 @@ int hd44780_init(Hd44780** out) {
     gpiod_request_config_set_consumer(rconf, "hd44780");
     gpiod_line_settings_set_direction(lset, GPIOD_LINE_DIRECTION_OUTPUT);
 
-    unsigned offsets[6] = { lcd->rs, lcd->e, lcd->d4, lcd->d5, lcd->d6, lcd->d7 };
+    unsigned offsets[5 + HD44780_MAX_PANELS] = { lcd->rs, lcd->d4, lcd->d5, lcd->d6, lcd->d7 };
+    unsigned noffsets = 5 + panels;
+    memcpy(offsets + 5, lcd->e, panels * sizeof(*lcd->e));
 
-    if (gpiod_line_config_add_line_settings(lconf, offsets, 6, lset) != 0) {
+    if (gpiod_line_config_add_line_settings(lconf, offsets, noffsets, lset) != 0) {
         gpiod_request_config_free(rconf);
         gpiod_line_settings_free(lset);
         gpiod_line_config_free(lconf);
@@ -95,24 +97,26 @@ int hd44780_init(Hd44780** out) {
     if (!lcd->req) { hd44780_deinit(lcd); return -1; }
 
     // initial values low
-    for (int i = 0; i < 6; i++) gpiod_line_request_set_value(lcd->req, offsets[i], 0);
+    for (unsigned i = 0; i < noffsets; i++) gpiod_line_request_set_value(lcd->req, offsets[i], 0);
 
     // power-on wait
     sleep_us(50000);
 
-    // 4-bit init sequence
-    setv(lcd, lcd->rs, 0);
-    write4(lcd, 0x03); sleep_us(5000);
-    write4(lcd, 0x03); sleep_us(200);
-    write4(lcd, 0x03); sleep_us(200);
-    write4(lcd, 0x02); sleep_us(200);
+    // 4-bit init sequence, every panel at once
+    unsigned all = (1u << panels) - 1;
+    write4(lcd, all, 0, 0x03); sleep_us(5000);
+    write4(lcd, all, 0, 0x03); sleep_us(200);
+    write4(lcd, all, 0, 0x03); sleep_us(200);
+    write4(lcd, all, 0, 0x02); sleep_us(200);
+
+    long exec_us = (long)((exec_ns ? exec_ns : HD44780_EXEC_NS) / 1000);
+    long clear_us = exec_us * (HD44780_CLEAR_NS / HD44780_EXEC_NS);
 
-    cmd(lcd, 0x28); // 4-bit, 2 line, 5x8
-    cmd(lcd, 0x08); // display off
-    cmd(lcd, 0x01); // clear
-    sleep_us(2000);
-    cmd(lcd, 0x06); // entry mode
-    cmd(lcd, 0x0C); // display on, cursor off
+    write8(lcd, all, 0, 0x28); sleep_us(exec_us);   // 4-bit, 2 line, 5x8 (four-line panels are two lines folded)
+    write8(lcd, all, 0, 0x08); sleep_us(exec_us);   // display off
+    write8(lcd, all, 0, HD44780_CMD_CLEAR); sleep_us(clear_us);
+    write8(lcd, all, 0, 0x06); sleep_us(exec_us);   // entry mode
+    write8(lcd, all, 0, 0x0C); sleep_us(exec_us);   // display on, cursor off
 
     *out = lcd;
     return 0;
@@ -125,40 +129,7 @@ void hd44780_deinit(Hd44780* lcd) {
     free(lcd);
 }
 
-int hd44780_clear(Hd44780* lcd) {
-    if (!lcd) return -1;
-    if (cmd(lcd, 0x01) != 0) return -1;
-    sleep_us(2000);
-    return 0;
-}
-
-int hd44780_set_cursor(Hd44780* lcd, int row, int col) {
-    if (!lcd) return -1;
-    if (col < 0) col = 0;
-    if (col > 15) col = 15;
-    int addr = (row == 0) ? (0x00 + col) : (0x40 + col);
-    return cmd(lcd, 0x80 | addr);
-}
-
-int hd44780_write_str(Hd44780* lcd, const char* s) {
-    if (!lcd || !s) return -1;
-    for (; *s; s++) {
-        if (dat(lcd, (unsigned char)*s) != 0) return -1;
-    }
-    return 0;
-}
-
-static void write_padded_line(Hd44780* lcd, int row, const char line[17]) {
-    hd44780_set_cursor(lcd, row, 0);
-    for (int i = 0; i < 16; i++) {
-        char c = line[i] ? line[i] : ' ';
-        dat(lcd, (unsigned char)c);
-    }
-}
-
-int hd44780_write_lines(Hd44780* lcd, const char line1[17], const char line2[17]) {
-    if (!lcd) return -1;
-    write_padded_line(lcd, 0, line1);
-    write_padded_line(lcd, 1, line2);
-    return 0;
+int hd44780_send(Hd44780* lcd, unsigned panel, int rs, uint8_t byte) {
+    if (!lcd || panel >= lcd->panels) return -1;
+    return write8(lcd, 1u << panel, rs, byte);
 }
@@ -2,15 +2,42 @@
 #define _DEFAULT_SOURCE
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <time.h>
 #include <unistd.h>
 #include <stdint.h>
 #include <signal.h>
+#include <string.h>
 
 #include "hardware_stats.h"
+#include "alerts/rules.h"
+#include "collectors/net_dev.h"
+#include "collectors/proc_top.h"
+#include "collectors/psi.h"
+#include "collectors/cpu_burst.h"
+#include "collectors/interrupts.h"
+#include "diag/perf_counters.h"
+#include "diag/self_stats.h"
+#include "sched/scheduler.h"
+#include "fleet/aggregator.h"
+#include "fleet/sender.h"
+#include "fleet/bench.h"
+#include "stream/stream_run.h"
 #include "page_manager.h"
-#include "lcd/hd44780.h"
+#include "pages/bench.h"
+#include "lcd/display.h"
 #include "input/buttons.h"
+#include "utility.h"
+
+#define BUTTON_POLL_MS            20
+#define BURST_SLICE_MS            20   // yakalamak istediğimiz en kısa CPU patlaması
+#define BURST_WINDOW_MS         1000
+#define ALERT_BLINK_MS           500
+#define LCD_PUMP_MS               10   // panel yazımına döngü başına ayrılan en fazla süre
+#define LCD_EXIT_MS              200
+#define RULES_DEFAULT_PATH      "/etc/hw_monitoring/rules.conf"
+#define HISTORY_DEFAULT_PATH    "/var/lib/hw_monitoring/history.ring"
+#define PAGES_DEFAULT_PATH      "/etc/hw_monitoring/pages.conf"
 
 static volatile sig_atomic_t g_stop = 0;
 
@@ -19,13 +46,143 @@ static void on_sigint(int sig) {
     g_stop = 1;
 }
 
+static void fleet_shutdown(void) {
+    fleet_simulate_stop();
+    fleet_aggregator_stop();
+    fleet_sender_close();
+}
+
 static uint64_t now_ms(void) {
     struct timespec ts;
     clock_gettime(CLOCK_MONOTONIC, &ts);
     return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
 }
 
-int main(void) {
+int main(int argc, char** argv) {
+    // kill -USR1 <pid>: monitörün kendi maliyetini stderr'e dök
+    diag_install_sigusr1();
+    perf_counters_init();
+
+    int terminal = 0;
+    unsigned burst_hz = 0;
+    const char* rules_path = NULL;
+    const char* stream_path = NULL;
+    const char* history_path = NULL;
+    const char* pages_path = NULL;
+    const char* fleet_target = NULL;
+    long fleet_port = -1;
+    unsigned simulate = 0, fleet_bench = 0;
+    int bench_pages = 0;
+    const char* bench_irq = NULL;
+    unsigned bench_top = 0, bench_cgroup = 0;
+    DisplayPanelConfig panels[DISPLAY_MAX_PANELS];
+    unsigned npanels = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--terminal") == 0) terminal = 1;
+        else if (strcmp(argv[i], "--rules") == 0 && i + 1 < argc) rules_path = argv[++i];
+        else if (strcmp(argv[i], "--pages") == 0 && i + 1 < argc) pages_path = argv[++i];
+        else if (strcmp(argv[i], "--history") == 0 && i + 1 < argc) history_path = argv[++i];
+        else if (strcmp(argv[i], "--stream") == 0 && i + 1 < argc) stream_path = argv[++i];
+        else if (strcmp(argv[i], "--burst") == 0 && i + 1 < argc) burst_hz = (unsigned)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--fleet-send") == 0 && i + 1 < argc) fleet_target = argv[++i];
+        else if (strcmp(argv[i], "--fleet-listen") == 0 && i + 1 < argc) fleet_port = strtol(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--simulate") == 0 && i + 1 < argc) simulate = (unsigned)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--bench-pages") == 0) bench_pages = 1;
+        else if (strcmp(argv[i], "--bench-irq") == 0 && i + 1 < argc) bench_irq = argv[++i];
+        else if (strcmp(argv[i], "--bench-top") == 0 && i + 1 < argc) bench_top = (unsigned)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--bench-cgroup") == 0 && i + 1 < argc) bench_cgroup = (unsigned)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--fleet-bench") == 0 && i + 1 < argc) fleet_bench = (unsigned)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--lcd") == 0 && i + 1 < argc) {
+            if (npanels == DISPLAY_MAX_PANELS || display_parse_panel(argv[++i], &panels[npanels]) != 0) {
+                fprintf(stderr, "--lcd COLSxROWS[@E_PIN][/EXEC_US], at most %d panels\n", DISPLAY_MAX_PANELS);
+                return 1;
+            }
+            npanels++;
+        }
+    }
+
+    // --bench-pages: şablon sayfa, snprintf'li yerleşik sayfa kadar hızlı mı
+    if (bench_pages) return page_benchmark();
+
+    // --bench-irq FILE: kayıtlı /proc/interrupts'u skaler ve SIMD ayrıştırıcıyla çöz, karşılaştır
+    if (bench_irq) return interrupts_benchmark(bench_irq);
+
+    // --bench-top N: N sürece kadar boşta çocuk süreç aç, tarama süresini ölç
+    if (bench_top) return proc_top_benchmark(bench_top);
+
+    // --bench-cgroup N: N boş cgroup oluştur, tick süresini ölç, sonra sil
+    if (bench_cgroup) return cgroup_benchmark(bench_cgroup);
+
+    // --fleet-bench N: loopback'ta N düğüm tam hızda, datagram/s ölç ve çık
+    if (fleet_bench) return fleet_benchmark(fleet_bench);
+
+    // --burst HZ: çekirdek başına /proc/stat'ı 100-1000 Hz örnekle
+    if (burst_hz && cpu_burst_start(burst_hz, BURST_SLICE_MS, BURST_WINDOW_MS) != 0) {
+        fprintf(stderr, "--burst needs 100..1000 Hz\n");
+        return 1;
+    }
+
+    // --fleet-listen PORT: diğer düğümlerin örneklerini topla (FLEET sayfası)
+    if (fleet_port >= 0) {
+        if (fleet_port > 65535 || fleet_aggregator_start((uint16_t)fleet_port) != 0) {
+            fprintf(stderr, "cannot listen for fleet datagrams on udp/%ld\n", fleet_port);
+            cpu_burst_stop();
+            return 1;
+        }
+        fprintf(stderr, "fleet aggregator on udp/%u\n", fleet_aggregator_port());
+    }
+
+    // --simulate N: N sahte düğüm, saniyede bir, kendi aggregator'ımıza
+    if (simulate) {
+        if (!fleet_aggregator_running() || fleet_simulate_start(fleet_aggregator_port(), simulate, 1) != 0) {
+            fprintf(stderr, "--simulate needs --fleet-listen\n");
+            cpu_burst_stop();
+            fleet_shutdown();
+            return 1;
+        }
+    }
+
+    // --fleet-send HOST:PORT: her örneği tek bir UDP datagramı olarak gönder
+    if (fleet_target && fleet_sender_open(fleet_target) != 0) {
+        fprintf(stderr, "cannot resolve fleet aggregator %s\n", fleet_target);
+        cpu_burst_stop();
+        fleet_shutdown();
+        return 1;
+    }
+
+    // varsayılan kural dosyası yoksa sessizce kuralsız çalış
+    int nrules = rules_load(rules_path ? rules_path : RULES_DEFAULT_PATH);
+    if (nrules < 0 && rules_path) fprintf(stderr, "cannot read rules file %s\n", rules_path);
+    else if (nrules >= 0) fprintf(stderr, "%d alert rules loaded\n", nrules);
+
+    // yeniden başlatmada son dakikaları ve CPU sayaçlarını devral;
+    // varsayılan dizin yoksa geçmişsiz çalış
+    int nhistory = stats_history_open(history_path ? history_path : HISTORY_DEFAULT_PATH);
+    if (nhistory < 0 && history_path) fprintf(stderr, "cannot open history file %s\n", history_path);
+    else if (nhistory >= 0) fprintf(stderr, "%d history samples recovered\n", nhistory);
+
+    // --stream PATH|-: LCD yok, ikili kayıt akışı (çözmek için hw_stream_decode)
+    if (stream_path) {
+        HardwareStats ts;
+        int rc = stream_stats(&ts, stream_path);
+        cpu_burst_stop();
+        fleet_shutdown();
+        rules_deinit();
+        stats_history_close();
+        return rc;
+    }
+
+    // LCD donanımı olmadan: sadece terminale yaz
+    if (terminal) {
+        HardwareStats ts;
+        int rc = display_stats_only_terminal(&ts);
+        cpu_burst_stop();
+        fleet_shutdown();
+        rules_deinit();
+        stats_history_close();
+        return rc;
+    }
+
     signal(SIGINT, on_sigint);
     signal(SIGTERM, on_sigint);
 
@@ -35,12 +192,26 @@ int main(void) {
         return 1;
     }
 
-    Hd44780* lcd = NULL;
-    if (hd44780_init(&lcd) != 0) {
-        fprintf(stderr, "hd44780_init failed (wiring/pins?)\n");
+    // şablon sayfalar yerleşiklerin ardına eklenir, aynı isimdekinin yerine geçer
+    int npages = page_manager_load(&pm, pages_path ? pages_path : PAGES_DEFAULT_PATH);
+    if (npages < 0 && pages_path) fprintf(stderr, "cannot read pages file %s\n", pages_path);
+    else if (npages >= 0) fprintf(stderr, "%d template pages loaded\n", npages);
+
+    // --lcd verilmezse pins.h'deki tek 16x2 panel
+    if (npanels == 0) {
+        display_parse_panel("16x2", &panels[0]);
+        npanels = 1;
+    }
+
+    Display* lcd = NULL;
+    if (display_open(&lcd, panels, npanels) != 0) {
+        fprintf(stderr, "display_open failed (wiring/pins?)\n");
         return 1;
     }
-    hd44780_clear(lcd);
+
+    // sayfalar her örnekte bir kez çizilir, tüm paneller aynı karoları paylaşır
+    PageTile tiles[DISPLAY_MAX_TILES];
+    unsigned ntiles = display_tiles(lcd);
 
     Buttons* btn = NULL;
     if (buttons_init(&btn) != 0) {
@@ -48,40 +219,79 @@ int main(void) {
         btn = NULL; // LCD yine de çalışsın
     }
 
+    // 100ms stall / 1s pencere: tetiklenince tüm kaynaklar en hızlı aralığa
+    if (psi_triggers_init(100000, 1000000) == 0) {
+        fprintf(stderr, "PSI triggers unavailable, sampling adapts to signal volatility only\n");
+    }
+
     HardwareStats s;
-    uint64_t last_stats_ms = 0;
+    memset(&s, 0, sizeof(s));
 
     while (!g_stop) {
+        uint64_t loop_start = diag_now_ns();
         uint64_t t = now_ms();
 
-        // 1 saniyede bir stats oku (CPU % doğru olsun diye daha mantıklı)
-        if (t - last_stats_ms >= 1000) {
-            if (read_system_stats(&s) != 0) {
-                hd44780_write_lines(lcd, "read_system_stats", "failed           ");
-            } else {
-                last_stats_ms = t;
-            }
+        // sadece zamanı gelen kolektörler çalışır (bkz. collectors[] hardware_stats.c)
+        int ran = read_due_stats(&s, loop_start);
+        if (ran > 0) {
+            uint64_t rules_start = diag_now_ns();
+            rules_evaluate(&s, rules_start);
+            diag_lap(DIAG_RULES, rules_start);
         }
 
-        // buton event (20ms polling yeter)
+        RuleAlert alert;
+        int flashing = rules_flash(&alert);
+
+        // buton event (20ms polling yeter); alarm yanıp sönerken ilk basış onaylar
         if (btn) {
             ButtonEvent e = buttons_poll(btn, t);
-            if (e == BTN_EVT_NEXT) page_manager_next(&pm);
+            if (flashing && e != BTN_EVT_NONE) rules_acknowledge();
+            else if (e == BTN_EVT_NEXT) page_manager_next(&pm);
             else if (e == BTN_EVT_PREV) page_manager_prev(&pm);
         }
 
-        char l1[17], l2[17];
-        page_manager_render(&pm, &s, l1, l2);
-        hd44780_write_lines(lcd, l1, l2);
+        // alarm ya da okuma hatası ilk karoyu (her panelin sol üstünü) alır
+        size_t shown = page_manager_render_tiles(&pm, &s, tiles, ntiles);
+        if (flashing) page_manager_render_alert(&alert, (int)((t / ALERT_BLINK_MS) & 1), tiles[0].line[0], tiles[0].line[1]);
+        else if (ran < 0) {
+            snprintf(tiles[0].line[0], sizeof(tiles[0].line[0]), "read_system_stat");
+            snprintf(tiles[0].line[1], sizeof(tiles[0].line[1]), "failed          ");
+        }
+
+        // sadece değişen hücreler gider; bitmeyen kısım bir sonraki turda
+        uint64_t lcd_start = diag_now_ns();
+        display_set_frame(lcd, tiles, (unsigned)shown);
+        display_pump(lcd, lcd_start + LCD_PUMP_MS * 1000000ULL);
+        diag_lap(DIAG_LCD_WRITE, lcd_start);
+
+        diag_poll_dump(stderr);
+        diag_lap(DIAG_LOOP, loop_start); // bekleme hariç, döngünün iş kısmı
 
-        usleep(20000); // 20ms
+        // bir sonraki kolektöre kadar bekle, butonlar için en fazla 20ms;
+        // bu sırada PSI tetiklenirse tüm kaynakları hızlandır
+        uint64_t now = diag_now_ns();
+        uint64_t deadline = read_due_stats_deadline();
+        uint64_t until_ms = deadline > now ? (deadline - now) / 1000000ULL : 0;
+        int wait_ms = until_ms < BUTTON_POLL_MS ? (int)until_ms : BUTTON_POLL_MS;
+        if (psi_triggers_wait(wait_ms) > 0) scheduler_boost(diag_now_ns());
     }
 
-    // çıkışta lcd temizle
-    hd44780_clear(lcd);
+    // çıkışta panelleri temizle
+    display_blank(lcd);
+    display_pump(lcd, diag_now_ns() + LCD_EXIT_MS * 1000000ULL);
 
     if (btn) buttons_deinit(btn);
-    hd44780_deinit(lcd);
+    display_close(lcd);
     page_manager_deinit(&pm);
+    proc_top_deinit();
+    net_dev_deinit();
+    psi_deinit();
+    cgroup_deinit();
+    interrupts_deinit();
+    cpu_burst_stop();
+    fleet_shutdown();
+    rules_deinit();
+    stats_history_close();
+    perf_counters_deinit();
     return 0;
 }
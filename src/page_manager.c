@@ -1,10 +1,22 @@
+#define _DEFAULT_SOURCE
 #include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "page_manager.h"
 #include "page.h"
 #include "hardware_stats.h"
+#include "diag/perf_counters.h"
+#include "diag/self_stats.h"
+#include "collectors/cpu_burst.h"
+#include "fleet/aggregator.h"
+#include "stats/estimators.h"
+#include "stats/fields.h"
+#include "pages/template.h"
+
+#define PAGE_NAME_MAX   16
+#define PAGE_LINE_MAX   256
 
 
 static void pad16(char line[LCD_COLS + 1]){
@@ -78,6 +90,24 @@ static void render_ram_page(const Page* page, const HardwareStats* s, char line1
 }
 
 
+static void render_vm_page(const Page* page, const HardwareStats* s, char line1[LCD_COLS + 1], char line2[LCD_COLS + 1]){
+
+    (void)page;
+
+    double swap_used_mb  = (s->swap_total_kb - s->swap_free_kb) / 1024.0;
+    double swap_total_mb = s->swap_total_kb / 1024.0;
+
+    snprintf(line1, LCD_COLS + 1, "Swp%5.0f/%5.0fM", swap_used_mb, swap_total_mb);
+
+    // major faults/s, swap-in/s, swap-out/s
+    snprintf(line2, LCD_COLS + 1, "MF%5.0f S%3.0f/%3.0f", s->pgmajfault_per_s, s->pswpin_per_s, s->pswpout_per_s);
+
+    pad16(line1);
+    pad16(line2);
+
+}
+
+
 static void render_temp_uptime_page(const Page* page, const HardwareStats* s,
                                     char line1[LCD_COLS + 1], char line2[LCD_COLS + 1])
 {
@@ -100,19 +130,350 @@ static void render_temp_uptime_page(const Page* page, const HardwareStats* s,
 
 
 
+// bytes (or bytes/s) into at most 4 chars + unit, e.g. "9.9K", " 123M"
+static void format_rate(double v, char out[8]){
+
+    const char units[] = {'B', 'K', 'M', 'G', 'T'};
+    size_t u = 0;
+
+    while(v >= 1000.0 && u < sizeof(units) - 1){
+
+        v /= 1024.0;
+        u++;
+
+    }
+
+    if(v < 10.0) snprintf(out, 8, "%3.1f%c", v, units[u]);
+    else         snprintf(out, 8, "%3.0f%c", v, units[u]);
+
+}
+
+
+static void render_net_page(const Page* page, const HardwareStats* s, char line1[LCD_COLS + 1], char line2[LCD_COLS + 1]){
+
+    (void)page;
+
+    if(s->net_iface[0] == '\0'){
+
+        snprintf(line1, LCD_COLS + 1, "NET: N/A");
+        snprintf(line2, LCD_COLS + 1, "ifaces:%u", s->net_iface_count);
+        pad16(line1);
+        pad16(line2);
+        return;
+
+    }
+
+    double bad_per_s = s->net_rx_errs_per_s + s->net_tx_errs_per_s + s->net_rx_drop_per_s + s->net_tx_drop_per_s;
+
+    snprintf(line1, LCD_COLS + 1, "%-9.9s E:%4.0f", s->net_iface, bad_per_s);
+
+    char rx[8], tx[8];
+    format_rate(s->net_rx_bytes_per_s, rx);
+    format_rate(s->net_tx_bytes_per_s, tx);
+
+    snprintf(line2, LCD_COLS + 1, "R:%.5s T:%.5s", rx, tx);
+
+    pad16(line1);
+    pad16(line2);
+
+}
+
+
+
+static void render_top_line(const HardwareStats* s, unsigned i, char line[LCD_COLS + 1]){
+
+    if(i >= s->top_proc_count){
+
+        snprintf(line, LCD_COLS + 1, "-");
+        return;
+
+    }
+
+    snprintf(line, LCD_COLS + 1, "%-10.10s%5.1f%%", s->top_procs[i].comm, s->top_procs[i].cpu_percent);
+
+}
+
+
+static void render_top_page(const Page* page, const HardwareStats* s, char line1[LCD_COLS + 1], char line2[LCD_COLS + 1]){
+
+    (void)page;
+
+    render_top_line(s, 0, line1);
+    render_top_line(s, 1, line2);
+
+    pad16(line1);
+    pad16(line2);
+
+}
+
+
+
+static void render_psi_page(const Page* page, const HardwareStats* s, char line1[LCD_COLS + 1], char line2[LCD_COLS + 1]){
+
+    (void)page;
+
+    if(!s->psi[PSI_CPU].available){
+
+        snprintf(line1, LCD_COLS + 1, "PSI: N/A");
+        line2[0] = '\0';
+        pad16(line1);
+        pad16(line2);
+        return;
+
+    }
+
+    // avg10 "some" stall percentages; memory "full" is the one that hurts
+    snprintf(line1, LCD_COLS + 1, "CPU%4.1f MEM%4.1f", s->psi[PSI_CPU].some_avg10, s->psi[PSI_MEMORY].some_avg10);
+    snprintf(line2, LCD_COLS + 1, "IO %4.1f MF%4.1f", s->psi[PSI_IO].some_avg10, s->psi[PSI_MEMORY].full_avg10);
+
+    pad16(line1);
+    pad16(line2);
+
+}
+
+
+
+static void render_cgroup_page(const Page* page, const HardwareStats* s, char line1[LCD_COLS + 1], char line2[LCD_COLS + 1]){
+
+    (void)page;
+
+    if(s->cgroup_count == 0){
+
+        snprintf(line1, LCD_COLS + 1, "CGROUP: N/A");
+        line2[0] = '\0';
+        pad16(line1);
+        pad16(line2);
+        return;
+
+    }
+
+    snprintf(line1, LCD_COLS + 1, "%-10.10s%5.1f%%", s->cgroup_top.name, s->cgroup_top.cpu_percent);
+
+    char mem[8];
+    format_rate((double)s->cgroup_top.memory_current, mem);
+
+    snprintf(line2, LCD_COLS + 1, "M:%.5s OOM:%llu", mem, s->cgroup_top.oom_kill);
+
+    pad16(line1);
+    pad16(line2);
+
+}
+
+
+
+static void render_irq_page(const Page* page, const HardwareStats* s, char line1[LCD_COLS + 1], char line2[LCD_COLS + 1]){
+
+    (void)page;
+
+    if(s->irq.hottest_irq[0] != '\0') snprintf(line1, LCD_COLS + 1, "%-9.9s%7.0f", s->irq.hottest_irq, s->irq.hottest_irq_per_s);
+    else                               snprintf(line1, LCD_COLS + 1, "IRQ%13.0f", s->irq.irq_total_per_s);
+
+    // imbalance: busiest cpu / mean cpu (1.0 = evenly spread)
+    snprintf(line2, LCD_COLS + 1, "Imb%4.1f RX%6.0f", s->irq.irq_imbalance, s->irq.net_rx_softirq_per_s);
+
+    pad16(line1);
+    pad16(line2);
+
+}
+
+
+
+static void render_diag_page(const Page* page, const HardwareStats* s, char line1[LCD_COLS + 1], char line2[LCD_COLS + 1]){
+
+    (void)page;
+    (void)s;
+
+    DiagSummary sample, lcd;
+    diag_summary(DIAG_SAMPLE, &sample);
+    diag_summary(DIAG_LCD_WRITE, &lcd);
+
+    PerfTotals p;
+    perf_counters_totals(&p);
+
+    double ipc = (p.have_cycles && p.have_instructions && p.cycles > 0) ? (double)p.instructions / (double)p.cycles : 0.0;
+
+    // sampler p50/p99 and lcd write p50 in microseconds
+    snprintf(line1, LCD_COLS + 1, "S%6.0f/%6.0fus", (double)sample.p50_ns / 1e3, (double)sample.p99_ns / 1e3);
+    snprintf(line2, LCD_COLS + 1, "L%6.0fus IPC%3.1f", (double)lcd.p50_ns / 1e3, ipc);
+
+    pad16(line1);
+    pad16(line2);
+
+}
+
+
+
+static void render_stat_page(const Page* page, const HardwareStats* s, char line1[LCD_COLS + 1], char line2[LCD_COLS + 1]){
+
+    (void)page;
+    (void)s;
+
+    static int cpu_field = -2, mem_field = -2;
+
+    if(cpu_field == -2){
+
+        cpu_field = stat_field_index("cpu");
+        mem_field = stat_field_index("mem.used_percent");
+
+    }
+
+    EstQuantiles cpu, mem;
+    estimators_quantiles(cpu_field, EST_WINDOW_1M, &cpu);
+    estimators_quantiles(mem_field, EST_WINDOW_1M, &mem);
+
+    // p50/p99 over the last minute
+    snprintf(line1, LCD_COLS + 1, "CPU 1m %3.0f/%3.0f%%", cpu.p50, cpu.p99);
+    snprintf(line2, LCD_COLS + 1, "RAM 1m %3.0f/%3.0f%%", mem.p50, mem.p99);
+
+    pad16(line1);
+    pad16(line2);
+
+}
+
+
+
+static void render_burst_page(const Page* page, const HardwareStats* s, char line1[LCD_COLS + 1], char line2[LCD_COLS + 1]){
+
+    (void)page;
+    (void)s;
+
+    CpuBurstWindow w;
+
+    if(cpu_burst_latest(&w) != 0 || w.hottest_core < 0){
+
+        snprintf(line1, LCD_COLS + 1, "Burst: off");
+        snprintf(line2, LCD_COLS + 1, "--burst HZ");
+
+    }
+
+    else{
+
+        const CpuBurstCore* c = &w.core[w.hottest_core];
+
+        CpuBurstOverhead oh;
+        cpu_burst_overhead(&oh);
+
+        // hottest core over 20 ms slices: p99 / max, and the sampler's own cost
+        snprintf(line1, LCD_COLS + 1, "c%-2d p99%3.0f mx%3.0f", w.hottest_core, c->p99, c->max);
+        snprintf(line2, LCD_COLS + 1, "%4.0fHz cost%4.2f%%", oh.actual_hz, oh.sampler_cpu_percent);
+
+    }
+
+    pad16(line1);
+    pad16(line2);
+
+}
+
+
+
+static void render_fleet_page(const Page* page, const HardwareStats* s, char line1[LCD_COLS + 1], char line2[LCD_COLS + 1]){
+
+    (void)page;
+    (void)s;
+
+    FleetView v;
+
+    if(fleet_aggregator_view(&v) != 0){
+
+        snprintf(line1, LCD_COLS + 1, "Fleet: off");
+        snprintf(line2, LCD_COLS + 1, "--fleet-listen");
+
+    }
+
+    else if(v.top_count[FLEET_RANK_TEMP] == 0){
+
+        snprintf(line1, LCD_COLS + 1, "Fleet: %u nodes", v.nodes - v.stale);
+        snprintf(line2, LCD_COLS + 1, "udp/%u", fleet_aggregator_port());
+
+    }
+
+    else{
+
+        // hottest node on top; below it the busiest core and the node lowest on memory take turns
+        const FleetEntry* hot = &v.top[FLEET_RANK_TEMP][0];
+        snprintf(line1, LCD_COLS + 1, "T %-8.8s%5.1fC", hot->node, hot->value);
+
+        if((v.published_ns / 2000000000ULL) & 1){
+
+            const FleetEntry* mem = &v.top[FLEET_RANK_MEM][0];
+            snprintf(line2, LCD_COLS + 1, "M %-8.8s%5.1f%%", mem->node, mem->value);
+
+        }
+
+        else{
+
+            const FleetEntry* core = &v.top[FLEET_RANK_CORE][0];
+            unsigned pct = core->value >= 100.0f ? 100u : core->value > 0.0f ? (unsigned)core->value : 0u;
+            snprintf(line2, LCD_COLS + 1, "C %-7.7s%3u%%c%u", core->node, pct, core->core % 100u);
+
+        }
+
+    }
+
+    pad16(line1);
+    pad16(line2);
+
+}
+
+
+
+// a page from the pages file; Page comes first so render can get back to the rest
+typedef struct TemplatePage {
+
+    Page         page;
+    char         name[PAGE_NAME_MAX];
+    PageTemplate line[2];
+
+}TemplatePage;
+
+
+static void render_template_page(const Page* page, const HardwareStats* s, char line1[LCD_COLS + 1], char line2[LCD_COLS + 1]){
+
+    const TemplatePage* tp = (const TemplatePage*)page;
+
+    page_template_render(&tp->line[0], s, line1, LCD_COLS);
+    page_template_render(&tp->line[1], s, line2, LCD_COLS);
+
+}
+
+
+
 static Page g_page_cpu = {.name = "CPU", .render = render_cpu_page, .next = NULL, .prev = NULL};
 
 
 static Page g_page_ram = {.name = "RAM", .render = render_ram_page, .next = NULL, .prev = NULL};
 
+static Page g_page_irq = {.name = "IRQ", .render = render_irq_page, .next = NULL, .prev = NULL};
+
+static Page g_page_burst = {.name = "BURST", .render = render_burst_page, .next = NULL, .prev = NULL};
+
+static Page g_page_stat = {.name = "STAT", .render = render_stat_page, .next = NULL, .prev = NULL};
+
+static Page g_page_diag = {.name = "DIAG", .render = render_diag_page, .next = NULL, .prev = NULL};
+
+static Page g_page_vm = {.name = "VM", .render = render_vm_page, .next = NULL, .prev = NULL};
+
 static Page g_page_temp = {.name = "TEMP", .render = render_temp_uptime_page, .next = NULL, .prev = NULL};
 
+static Page g_page_net = {.name = "NET", .render = render_net_page, .next = NULL, .prev = NULL};
 
-static void link_circular_3(Page* a, Page* b, Page* c){
+static Page g_page_top = {.name = "TOP", .render = render_top_page, .next = NULL, .prev = NULL};
 
-    a->next = b; b->prev = a;
-    b->next = c; c->prev = b;
-    c->next = a; a->prev = c;
+static Page g_page_psi = {.name = "PSI", .render = render_psi_page, .next = NULL, .prev = NULL};
+
+static Page g_page_cgroup = {.name = "CGROUP", .render = render_cgroup_page, .next = NULL, .prev = NULL};
+
+static Page g_page_fleet = {.name = "FLEET", .render = render_fleet_page, .next = NULL, .prev = NULL};
+
+
+static void link_circular(Page* pages[], size_t n){
+
+    for(size_t i = 0; i < n; i++){
+
+        pages[i]->next = pages[(i + 1) % n];
+        pages[i]->prev = pages[(i + n - 1) % n];
+
+    }
 
 }
 
@@ -124,11 +485,20 @@ int page_manager_init(PageManager* pm){
 
     memset(pm, 0, sizeof(*pm));
 
-    link_circular_3(&g_page_cpu, &g_page_ram, &g_page_temp);
+    static Page* const builtin[] = {&g_page_cpu, &g_page_burst, &g_page_top, &g_page_ram, &g_page_vm, &g_page_psi, &g_page_cgroup, &g_page_temp, &g_page_net, &g_page_irq, &g_page_stat, &g_page_fleet, &g_page_diag};
+    const size_t n = sizeof(builtin) / sizeof(builtin[0]);
+
+    pm->pages = malloc(n * sizeof(*pm->pages));
+
+    if(!pm->pages) return -1;
+
+    memcpy(pm->pages, builtin, sizeof(builtin));
 
-    pm->head = &g_page_cpu;
+    link_circular(pm->pages, n);
+
+    pm->head = pm->pages[0];
     pm->current = pm->head;
-    pm->count = 3;
+    pm->count = n;
 
     return 0;
 
@@ -137,12 +507,165 @@ int page_manager_init(PageManager* pm){
 void page_manager_deinit(PageManager *pm){
 
     if(!pm) return;
+
+    for(size_t i = 0; i < pm->count; i++){
+
+        if(pm->pages[i]->render == render_template_page) free(pm->pages[i]);
+
+    }
+
+    free(pm->pages);
+    pm->pages = NULL;
     pm->head = NULL;
     pm->current = NULL;
     pm->count = 0;
 
 }
 
+
+
+// same name as a loaded page: replace it in place, otherwise append
+static int add_page(PageManager* pm, Page* page){
+
+    for(size_t i = 0; i < pm->count; i++){
+
+        if(strcmp(pm->pages[i]->name, page->name) != 0) continue;
+
+        if(pm->pages[i]->render == render_template_page) free(pm->pages[i]);
+
+        pm->pages[i] = page;
+        return 0;
+
+    }
+
+    Page** grown = realloc(pm->pages, (pm->count + 1) * sizeof(*grown));
+
+    if(!grown) return -1;
+
+    pm->pages = grown;
+    pm->pages[pm->count++] = page;
+
+    return 0;
+}
+
+
+static char* trim_line(char* line){
+
+    size_t n = strcspn(line, "\r\n");
+    line[n] = '\0';
+
+    // quotes keep leading/trailing spaces
+    if(n >= 2 && line[0] == '"' && line[n - 1] == '"'){
+
+        line[n - 1] = '\0';
+        return line + 1;
+
+    }
+
+    return line;
+}
+
+
+int page_manager_load(PageManager* pm, const char* path){
+
+    if(!pm || !pm->pages || !path) return -1;
+
+    FILE* f = fopen(path, "r");
+
+    if(!f) return -1;
+
+    char buf[PAGE_LINE_MAX];
+    unsigned lineno = 0;
+    int loaded = 0;
+
+    TemplatePage* cur = NULL;
+    unsigned rows = 0;
+    int bad = 0;
+
+    for(;;){
+
+        char* line = fgets(buf, sizeof(buf), f) ? buf : NULL;
+
+        if(line) lineno++;
+
+        int header = line && line[0] == '[';
+
+        // a page is complete at the next header or at end of file
+        if((header || !line) && cur){
+
+            if(!bad && add_page(pm, &cur->page) == 0) loaded++;
+            else free(cur);
+
+            cur = NULL;
+
+        }
+
+        if(!line) break;
+
+        if(line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0') continue;
+
+        if(header){
+
+            char* close = strchr(line, ']');
+            size_t len = close ? (size_t)(close - line - 1) : 0;
+
+            if(len == 0 || len >= PAGE_NAME_MAX){
+
+                fprintf(stderr, "%s:%u: bad page name\n", path, lineno);
+                continue;
+
+            }
+
+            cur = calloc(1, sizeof(*cur));
+
+            if(!cur) break;
+
+            memcpy(cur->name, line + 1, len);
+            cur->page.name = cur->name;
+            cur->page.render = render_template_page;
+            rows = 0;
+            bad = 0;
+            continue;
+
+        }
+
+        if(!cur){
+
+            fprintf(stderr, "%s:%u: text outside a [PAGE]\n", path, lineno);
+            continue;
+
+        }
+
+        if(rows >= 2){
+
+            fprintf(stderr, "%s:%u: a page has at most two lines\n", path, lineno);
+            bad = 1;
+            continue;
+
+        }
+
+        const char* err = NULL;
+
+        if(page_template_compile(&cur->line[rows], trim_line(line), &err) != 0){
+
+            fprintf(stderr, "%s:%u: %s\n", path, lineno, err);
+            bad = 1;
+
+        }
+
+        rows++;
+
+    }
+
+    fclose(f);
+
+    link_circular(pm->pages, pm->count);
+    pm->head = pm->pages[0];
+    pm->current = pm->head;
+
+    return loaded;
+}
+
 void page_manager_next(PageManager* pm){
 
     if(!pm || !pm->current) return;
@@ -176,11 +699,47 @@ void page_manager_render(const PageManager *pm, const HardwareStats *stats, char
     }
 
 
+    uint64_t t = diag_now_ns();
+
     pm->current->render(pm->current, stats, line1, line2);
 
     pad16(line1);
     pad16(line2);
 
+    diag_lap(DIAG_PAGE_RENDER, t);
+
+
+}
+
+
+
+size_t page_manager_render_tiles(const PageManager* pm, const HardwareStats* stats, PageTile* tiles, size_t n){
+
+    if(!pm || !pm->current || !stats || n == 0){
+
+        if(n > 0) page_manager_render(pm, stats, tiles[0].line[0], tiles[0].line[1]);
+        return n > 0 ? 1 : 0;
+
+    }
+
+    uint64_t t = diag_now_ns();
+
+    // a page is shown once, even if the panels have room for more tiles than there are pages
+    size_t count = n < pm->count ? n : pm->count;
+    const Page* page = pm->current;
+
+    for(size_t i = 0; i < count; i++, page = page->next){
+
+        page->render(page, stats, tiles[i].line[0], tiles[i].line[1]);
+
+        pad16(tiles[i].line[0]);
+        pad16(tiles[i].line[1]);
+
+    }
+
+    diag_lap(DIAG_PAGE_RENDER, t);
+
+    return count;
 
 }
 
@@ -192,4 +751,80 @@ const char* page_manager_current_name(const PageManager* pm){
 
     return pm->current->name ? pm->current->name : "NONAME";
 
-}
\ No newline at end of file
+}
+
+
+
+// "psi.memory.some10" in at most width chars: then "p.m.some10", "m.some10", "some10", "some"
+static void alert_field_label(const char* field, size_t width, char* out){
+
+    size_t len = strnlen(field, width + 1);
+
+    if(len <= width){
+
+        memcpy(out, field, len);
+        out[len] = '\0';
+        return;
+
+    }
+
+    const char* last = strrchr(field, '.');
+    last = last ? last + 1 : field;
+
+    // first letter of every component before the last one
+    char initials[32];
+    size_t n = 0;
+
+    for(const char* p = field; p < last && n + 2 < sizeof(initials); p = strchr(p, '.') + 1){
+
+        initials[n++] = *p;
+        initials[n++] = '.';
+
+    }
+
+    initials[n] = '\0';
+
+    const char* prefix = initials;
+
+    size_t last_len = strlen(last);
+
+    while(*prefix && strlen(prefix) + last_len > width) prefix += 2;
+
+    size_t np = strlen(prefix);
+    size_t nl = last_len < width - np ? last_len : width - np;
+
+    memcpy(out, prefix, np);
+    memcpy(out + np, last, nl);
+    out[np + nl] = '\0';
+
+}
+
+
+
+void page_manager_render_alert(const RuleAlert* alert, int phase, char line1[LCD_COLS + 1], char line2[LCD_COLS + 1]){
+
+    // line 1 blinks, line 2 keeps the reading on screen
+    if(phase) snprintf(line1, LCD_COLS + 1, "!%-.14s!", alert->name);
+    else line1[0] = '\0';
+
+    // the reading first, the field name gets what is left of the line
+    char reading[LCD_COLS + 1];
+    snprintf(reading, sizeof(reading), "%.1f%s%.0f", alert->value, alert->op, alert->threshold);
+
+    size_t used = strlen(reading) + 1;
+    char* p = line2;
+
+    if(used < LCD_COLS){
+
+        alert_field_label(alert->field, LCD_COLS - used, line2);
+        p += strlen(line2);
+        if(p > line2) *p++ = ' ';
+
+    }
+
+    memcpy(p, reading, used);
+
+    pad16(line1);
+    pad16(line2);
+
+}
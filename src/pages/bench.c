@@ -0,0 +1,119 @@
+#include "pages/bench.h"
+#include "pages/template.h"
+#include "page_manager.h"
+#include "diag/self_stats.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* =======================
+ * Internal structures
+ * ======================= */
+
+#define BENCH_INPUTS    1024
+#define BENCH_RENDERS   1000000
+#define BENCH_ROUNDS    5
+
+/*
+ * The built-in CPU page against a template that prints the same two
+ * lines. Both render the same inputs; the best of a few rounds counts.
+ */
+static const char* const g_cpu_template[2] = { "CPU:{cpu:5.1}% {temp:2.0}C", "Load:{load1:5.2}" };
+
+typedef struct {
+    double cpu, temp, load1;
+} BenchInput;
+
+/* =======================
+ * Helpers
+ * ======================= */
+
+static void set_input(HardwareStats* s, const BenchInput* x) {
+    s->cpu_usage_percent = x->cpu;
+    s->cpu_temp_c = x->temp;
+    s->load1 = x->load1;
+}
+
+// builtin or tpl, whichever is set; ns per render
+static double bench_round(const Page* builtin, const PageTemplate* tpl, const BenchInput* in,
+                          HardwareStats* s, char out[2][LCD_COLS + 1]) {
+    uint64_t t = diag_now_ns();
+
+    for (unsigned i = 0; i < BENCH_RENDERS; i++) {
+        set_input(s, &in[i % BENCH_INPUTS]);
+        if (builtin) {
+            builtin->render(builtin, s, out[0], out[1]);
+        } else {
+            page_template_render(&tpl[0], s, out[0], LCD_COLS);
+            page_template_render(&tpl[1], s, out[1], LCD_COLS);
+        }
+    }
+
+    return (double)(diag_now_ns() - t) / BENCH_RENDERS;
+}
+
+/* =======================
+ * Public API
+ * ======================= */
+
+int page_benchmark(void) {
+    PageManager pm;
+    if (page_manager_init(&pm) != 0) return 1;
+
+    const Page* builtin = NULL;
+    for (size_t i = 0; i < pm.count; i++)
+        if (strcmp(pm.pages[i]->name, "CPU") == 0) builtin = pm.pages[i];
+
+    PageTemplate tpl[2];
+    const char* err = NULL;
+    for (int l = 0; l < 2; l++) {
+        if (!builtin || page_template_compile(&tpl[l], g_cpu_template[l], &err) != 0) {
+            fprintf(stderr, "page bench: %s\n", err ? err : "no CPU page");
+            page_manager_deinit(&pm);
+            return 1;
+        }
+    }
+
+    // spread over the whole range, halves and other rounding edges included
+    static BenchInput in[BENCH_INPUTS];
+    uint64_t rng = 0x9e3779b97f4a7c15ULL;
+    for (unsigned i = 0; i < BENCH_INPUTS; i++) {
+        rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+        in[i].cpu   = (double)(rng % 100001) / 1000.0;
+        in[i].temp  = 30.0 + (double)((rng >> 20) % 6001) / 100.0;
+        in[i].load1 = (double)((rng >> 40) % 160001) / 10000.0;
+    }
+
+    static HardwareStats s;
+    memset(&s, 0, sizeof(s));
+
+    // same digits first, or the timing means nothing
+    unsigned mismatches = 0;
+    for (unsigned i = 0; i < BENCH_INPUTS; i++) {
+        char a[2][LCD_COLS + 1], b[2][LCD_COLS + 1];
+        set_input(&s, &in[i]);
+        builtin->render(builtin, &s, a[0], a[1]);
+        page_template_render(&tpl[0], &s, b[0], LCD_COLS);
+        page_template_render(&tpl[1], &s, b[1], LCD_COLS);
+
+        if ((strcmp(a[0], b[0]) != 0 || strcmp(a[1], b[1]) != 0) && mismatches++ < 3)
+            fprintf(stderr, "page bench: [%s|%s] vs template [%s|%s]\n", a[0], a[1], b[0], b[1]);
+    }
+
+    double best_builtin = 0.0, best_template = 0.0;
+    char out[2][LCD_COLS + 1];
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        double a = bench_round(builtin, NULL, in, &s, out);
+        double b = bench_round(NULL, tpl, in, &s, out);
+        if (r == 0 || a < best_builtin) best_builtin = a;
+        if (r == 0 || b < best_template) best_template = b;
+    }
+
+    printf("page bench: CPU page, %u renders x %d rounds, best round\n", BENCH_RENDERS, BENCH_ROUNDS);
+    printf("  snprintf  %8.1f ns/render\n", best_builtin);
+    printf("  template  %8.1f ns/render  (%.2fx)\n", best_template, best_builtin / best_template);
+    printf("  output    %s (%u of %u inputs differ)\n", mismatches ? "DIFFERS" : "identical", mismatches, BENCH_INPUTS);
+
+    page_manager_deinit(&pm);
+    return mismatches ? 1 : 0;
+}
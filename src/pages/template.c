@@ -0,0 +1,286 @@
+#include "pages/template.h"
+#include "stats/fields.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* =======================
+ * Internal structures
+ * ======================= */
+
+#define FIELD_NAME_MAX  48
+#define PRECISION_MAX   9
+#define WIDTH_MAX       63
+#define NUM_BUF         32
+
+static const double g_pow10[PRECISION_MAX + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9
+};
+
+/* =======================
+ * Helpers
+ * ======================= */
+
+// literal text is appended to the pool in order, so it ends after the last literal op
+static size_t literal_used(const PageTemplate* t) {
+    for (unsigned i = t->op_count; i-- > 0;)
+        if (t->op[i].kind == TEMPLATE_LITERAL) return t->op[i].offset + t->op[i].len;
+    return 0;
+}
+
+static int add_literal(PageTemplate* t, char c, const char** err) {
+    size_t used = literal_used(t);
+    if (used >= TEMPLATE_LITERAL_MAX) {
+        *err = "too much literal text";
+        return -1;
+    }
+
+    TemplateOp* last = t->op_count ? &t->op[t->op_count - 1] : NULL;
+    if (last && last->kind == TEMPLATE_LITERAL) {
+        last->len++;
+    } else {
+        if (t->op_count >= TEMPLATE_MAX_OPS) {
+            *err = "too many fields";
+            return -1;
+        }
+        TemplateOp* op = &t->op[t->op_count++];
+        memset(op, 0, sizeof(*op));
+        op->kind = TEMPLATE_LITERAL;
+        op->offset = (uint32_t)used;
+        op->len = 1;
+    }
+    t->literals[used] = c;
+    return 0;
+}
+
+// p points just past '{'; returns the position after '}' or NULL
+static const char* parse_field(PageTemplate* t, const char* p, const char** err) {
+    char name[FIELD_NAME_MAX];
+    size_t n = 0;
+    while (*p && *p != '}' && *p != ':' && *p != '*' && *p != '/') {
+        if (n + 1 >= sizeof(name)) {
+            *err = "field name too long";
+            return NULL;
+        }
+        name[n++] = *p++;
+    }
+    name[n] = '\0';
+
+    const StatField* f = stat_field_find(name);
+    if (!f) {
+        *err = "unknown field";
+        return NULL;
+    }
+    if (t->op_count >= TEMPLATE_MAX_OPS) {
+        *err = "too many fields";
+        return NULL;
+    }
+
+    TemplateOp op;
+    memset(&op, 0, sizeof(op));
+    op.kind = TEMPLATE_NUMBER;
+    op.type = (uint8_t)f->type;
+    op.offset = (uint32_t)f->offset;
+    op.scale = 1.0;
+    op.precision = f->type == STAT_DOUBLE ? 1 : 0;
+
+    if (*p == '*' || *p == '/') {
+        char opc = *p++;
+        char* end;
+        double k = strtod(p, &end);
+        if (end == p || k == 0.0 || !isfinite(k)) {
+            *err = "bad scale";
+            return NULL;
+        }
+        op.scale = opc == '*' ? k : 1.0 / k;
+        op.precision = 1;
+        p = end;
+    }
+
+    if (*p == ':') {
+        p++;
+        for (;; p++) {
+            if (*p == '-') op.left = 1;
+            else if (*p == '0') op.zero = 1;
+            else break;
+        }
+        unsigned w = 0;
+        while (*p >= '0' && *p <= '9') w = w * 10 + (unsigned)(*p++ - '0');
+        if (w > WIDTH_MAX) {
+            *err = "width too large";
+            return NULL;
+        }
+        op.width = (uint8_t)w;
+        if (*p == '.') {
+            unsigned prec = 0;
+            p++;
+            while (*p >= '0' && *p <= '9') prec = prec * 10 + (unsigned)(*p++ - '0');
+            if (prec > PRECISION_MAX) {
+                *err = "precision too large";
+                return NULL;
+            }
+            op.precision = (uint8_t)prec;
+        }
+        if (*p == 'b') {
+            op.kind = TEMPLATE_BYTES;
+            p++;
+        }
+    }
+
+    if (*p != '}') {
+        *err = "expected '}'";
+        return NULL;
+    }
+    t->op[t->op_count++] = op;
+    return p + 1;
+}
+
+static size_t put_digits(char* buf, uint64_t u, unsigned frac, int neg) {
+    char tmp[NUM_BUF];
+    size_t n = 0;
+    for (unsigned i = 0; i < frac; i++) {
+        tmp[n++] = (char)('0' + u % 10);
+        u /= 10;
+    }
+    if (frac) tmp[n++] = '.';
+    do {
+        tmp[n++] = (char)('0' + u % 10);
+        u /= 10;
+    } while (u);
+    if (neg) tmp[n++] = '-';
+    for (size_t i = 0; i < n; i++) buf[i] = tmp[n - 1 - i];
+    return n;
+}
+
+/*
+ * Same digits as "%.*f". v * 10^prec is off by at most half an ulp, which
+ * only changes the rounding when the fraction is that close to .5; there
+ * (exact ties included, which printf rounds to even) snprintf decides.
+ */
+static size_t format_fixed(char* buf, double v, unsigned prec) {
+    double scaled = fabs(v) * g_pow10[prec];
+    double frac = scaled - floor(scaled);
+    double ulp = nextafter(scaled, INFINITY) - scaled;
+
+    if (!isfinite(v) || scaled >= 9e15 || fabs(frac - 0.5) <= 2.0 * ulp) {
+        int n = snprintf(buf, NUM_BUF, "%.*f", (int)prec, v);
+        return n < 0 ? 0 : (size_t)n >= NUM_BUF ? NUM_BUF - 1 : (size_t)n;
+    }
+    long long x = llround(v * g_pow10[prec]);
+    int neg = signbit(v);     // like printf, -0.04 at precision 1 is "-0.0"
+    return put_digits(buf, x < 0 ? (uint64_t)-x : (uint64_t)x, prec, neg);
+}
+
+// "%3.1f%c" / "%3.0f%c" of the value in B/K/M/G/T
+static size_t format_bytes(char* buf, double v) {
+    static const char units[] = {'B', 'K', 'M', 'G', 'T'};
+    size_t u = 0;
+    while (v >= 1000.0 && u < sizeof(units) - 1) {
+        v /= 1024.0;
+        u++;
+    }
+    char num[NUM_BUF];
+    size_t n = format_fixed(num, v, v < 10.0 ? 1 : 0);
+    size_t pad = n < 3 ? 3 - n : 0;
+    memset(buf, ' ', pad);
+    memcpy(buf + pad, num, n);
+    buf[pad + n] = units[u];
+    return pad + n + 1;
+}
+
+static size_t format_op(const TemplateOp* op, const HardwareStats* s, char* buf) {
+    const char* p = (const char*)s + op->offset;
+
+    // integer counters print exactly when unscaled
+    if (op->kind == TEMPLATE_NUMBER && op->scale == 1.0 && op->precision == 0) {
+        switch (op->type) {
+            case STAT_LONG: {
+                long v = *(const long*)p;
+                return put_digits(buf, v < 0 ? (uint64_t)0 - (uint64_t)v : (uint64_t)v, 0, v < 0);
+            }
+            case STAT_UINT: return put_digits(buf, *(const unsigned*)p, 0, 0);
+            case STAT_ULL:  return put_digits(buf, *(const unsigned long long*)p, 0, 0);
+            default: break;
+        }
+    }
+
+    double v;
+    switch (op->type) {
+        case STAT_LONG: v = (double)*(const long*)p; break;
+        case STAT_UINT: v = (double)*(const unsigned*)p; break;
+        case STAT_ULL:  v = (double)*(const unsigned long long*)p; break;
+        default:        v = *(const double*)p; break;
+    }
+    v *= op->scale;
+
+    return op->kind == TEMPLATE_BYTES ? format_bytes(buf, v) : format_fixed(buf, v, op->precision);
+}
+
+static char* put(char* p, const char* end, char c) {
+    if (p < end) *p++ = c;
+    return p;
+}
+
+/* =======================
+ * Public API
+ * ======================= */
+
+int page_template_compile(PageTemplate* t, const char* src, const char** err) {
+    static const char* ignored;
+    if (!err) err = &ignored;
+    memset(t, 0, sizeof(*t));
+
+    const char* p = src;
+    while (*p) {
+        if (p[0] == '{' && p[1] == '{') {
+            if (add_literal(t, '{', err) != 0) return -1;
+            p += 2;
+        } else if (*p == '{') {
+            p = parse_field(t, p + 1, err);
+            if (!p) return -1;
+        } else {
+            if (add_literal(t, *p, err) != 0) return -1;
+            p++;
+        }
+    }
+    return 0;
+}
+
+void page_template_render(const PageTemplate* t, const HardwareStats* s, char* out, size_t cols) {
+    char* p = out;
+    const char* end = out + cols;
+    char buf[NUM_BUF];
+
+    for (unsigned i = 0; i < t->op_count && p < end; i++) {
+        const TemplateOp* op = &t->op[i];
+
+        if (op->kind == TEMPLATE_LITERAL) {
+            size_t n = op->len;
+            if (n > (size_t)(end - p)) n = (size_t)(end - p);
+            memcpy(p, t->literals + op->offset, n);
+            p += n;
+            continue;
+        }
+
+        size_t n = format_op(op, s, buf);
+        size_t pad = op->width > n ? op->width - n : 0;
+        size_t k = 0;
+
+        if (op->left) {
+            for (; k < n; k++) p = put(p, end, buf[k]);
+            while (pad--) p = put(p, end, ' ');
+        } else if (op->zero) {
+            if (n && buf[0] == '-') p = put(p, end, buf[k++]);
+            while (pad--) p = put(p, end, '0');
+            for (; k < n; k++) p = put(p, end, buf[k]);
+        } else {
+            while (pad--) p = put(p, end, ' ');
+            for (; k < n; k++) p = put(p, end, buf[k]);
+        }
+    }
+
+    while (p < end) *p++ = ' ';
+    *p = '\0';
+}
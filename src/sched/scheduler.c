@@ -0,0 +1,181 @@
+#include "sched/scheduler.h"
+
+#include <math.h>
+#include <string.h>
+
+/* =======================
+ * Internal structures
+ * ======================= */
+
+// sources due within this much of the wakeup run in it too
+#define SCHEDULER_SLACK_NS  (5ULL * 1000000ULL)
+
+typedef struct {
+    SchedulerConfig cfg;
+    uint32_t interval_ms;
+    uint64_t next_ns;
+    double   last_signal;
+    int      has_signal;
+    double   volatility;
+    double   cost_us;
+    uint64_t runs;
+    int      in_heap;
+} SchedulerSource;
+
+static SchedulerSource g_sources[SCHEDULER_MAX_SOURCES];
+static size_t g_source_count = 0;
+
+// binary min-heap of source ids keyed by next_ns
+static int    g_heap[SCHEDULER_MAX_SOURCES];
+static size_t g_heap_size = 0;
+
+/* =======================
+ * Heap
+ * ======================= */
+
+static int earlier(int a, int b) {
+    return g_sources[a].next_ns < g_sources[b].next_ns;
+}
+
+static void heap_push(int id) {
+    size_t i = g_heap_size++;
+    g_heap[i] = id;
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!earlier(g_heap[i], g_heap[parent])) break;
+        int tmp = g_heap[i]; g_heap[i] = g_heap[parent]; g_heap[parent] = tmp;
+        i = parent;
+    }
+    g_sources[id].in_heap = 1;
+}
+
+static int heap_pop(void) {
+    int top = g_heap[0];
+    g_heap[0] = g_heap[--g_heap_size];
+
+    size_t i = 0;
+    for (;;) {
+        size_t l = 2 * i + 1, r = l + 1, m = i;
+        if (l < g_heap_size && earlier(g_heap[l], g_heap[m])) m = l;
+        if (r < g_heap_size && earlier(g_heap[r], g_heap[m])) m = r;
+        if (m == i) break;
+        int tmp = g_heap[i]; g_heap[i] = g_heap[m]; g_heap[m] = tmp;
+        i = m;
+    }
+
+    g_sources[top].in_heap = 0;
+    return top;
+}
+
+/* =======================
+ * Helpers
+ * ======================= */
+
+// a source may not run more often than its measured cost allows under its CPU budget
+static uint32_t budget_floor_ms(const SchedulerSource* s) {
+    if (s->cfg.budget <= 0.0 || s->runs == 0) return s->cfg.min_ms;
+    double ms = s->cost_us / 1000.0 / s->cfg.budget;
+    if (ms > s->cfg.max_ms) return s->cfg.max_ms;
+    return ms > s->cfg.min_ms ? (uint32_t)ms : s->cfg.min_ms;
+}
+
+/* =======================
+ * Public API
+ * ======================= */
+
+int scheduler_add(const SchedulerConfig* cfg, uint64_t now_ns) {
+    if (!cfg || g_source_count >= SCHEDULER_MAX_SOURCES) return -1;
+
+    int id = (int)g_source_count++;
+    SchedulerSource* s = &g_sources[id];
+    memset(s, 0, sizeof(*s));
+    s->cfg = *cfg;
+    if (s->cfg.max_ms < s->cfg.min_ms) s->cfg.max_ms = s->cfg.min_ms;
+    s->interval_ms = s->cfg.min_ms;
+    s->next_ns = now_ns;
+
+    heap_push(id);
+    return id;
+}
+
+uint64_t scheduler_next_deadline(void) {
+    return g_heap_size ? g_sources[g_heap[0]].next_ns : UINT64_MAX;
+}
+
+size_t scheduler_pop_due(uint64_t now_ns, int* ids, size_t max) {
+    size_t n = 0;
+    while (n < max && g_heap_size > 0 && g_sources[g_heap[0]].next_ns <= now_ns + SCHEDULER_SLACK_NS) {
+        ids[n++] = heap_pop();
+    }
+    return n;
+}
+
+void scheduler_report(int id, uint64_t now_ns, double signal, uint64_t cost_ns) {
+    if (id < 0 || (size_t)id >= g_source_count) return;
+    SchedulerSource* s = &g_sources[id];
+
+    double cost_us = (double)cost_ns / 1e3;
+    s->cost_us = s->runs ? 0.8 * s->cost_us + 0.2 * cost_us : cost_us;
+    s->runs++;
+
+    if (s->has_signal) {
+        double base = fabs(s->last_signal);
+        if (base < s->cfg.floor) base = s->cfg.floor;
+        double change = fabs(signal - s->last_signal) / base;
+        // smoothed so a single spike speeds up but one quiet run does not slow down
+        s->volatility = change > s->volatility ? change : 0.7 * s->volatility + 0.3 * change;
+    }
+    s->last_signal = signal;
+
+    uint32_t interval = s->interval_ms;
+    if (!s->has_signal) {
+        // first run only sets the baseline
+    } else if (s->volatility > s->cfg.threshold) {
+        interval = s->cfg.min_ms;
+    } else if (s->volatility < s->cfg.threshold / 4.0) {
+        interval = interval * 2 > s->cfg.max_ms ? s->cfg.max_ms : interval * 2;
+    }
+    s->has_signal = 1;
+
+    uint32_t floor_ms = budget_floor_ms(s);
+    if (interval < floor_ms) interval = floor_ms;
+    s->interval_ms = interval;
+
+    s->next_ns = now_ns + (uint64_t)interval * 1000000ULL;
+    if (!s->in_heap) heap_push(id);
+}
+
+void scheduler_boost(uint64_t now_ns) {
+    g_heap_size = 0;
+    for (size_t i = 0; i < g_source_count; i++) {
+        SchedulerSource* s = &g_sources[i];
+        // a source popped but not yet reported stays out; report() re-arms it at min_ms
+        int was_queued = s->in_heap;
+        s->interval_ms = budget_floor_ms(s);
+        s->volatility = s->cfg.threshold;   // decays back over a few quiet runs
+        s->in_heap = 0;
+        if (was_queued) {
+            s->next_ns = now_ns;
+            heap_push((int)i);
+        }
+    }
+}
+
+size_t scheduler_status(SchedulerStatus* out, size_t max) {
+    size_t n = 0;
+    for (; n < g_source_count && n < max; n++) {
+        const SchedulerSource* s = &g_sources[n];
+        out[n].name = s->cfg.name;
+        out[n].interval_ms = s->interval_ms;
+        out[n].volatility = s->volatility;
+        out[n].cost_us = s->cost_us;
+        out[n].runs = s->runs;
+    }
+    return n;
+}
+
+void scheduler_reset(void) {
+    memset(g_sources, 0, sizeof(g_sources));
+    g_source_count = 0;
+    g_heap_size = 0;
+}
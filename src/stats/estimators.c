@@ -0,0 +1,223 @@
+#include "stats/estimators.h"
+#include "stats/fields.h"
+
+#include <math.h>
+#include <string.h>
+
+/* =======================
+ * Internal structures
+ * ======================= */
+
+static const double g_ewma_tau_s[EST_EWMA_COUNT] = { 10.0, 60.0, 300.0 };
+static const uint64_t g_window_ns[EST_WINDOW_COUNT] = { 60ULL * 1000000000ULL, 300ULL * 1000000000ULL };
+
+// ring entry of a field that a partial update did not carry
+#define NO_SAMPLE (-1)
+
+typedef struct {
+    double   ewma[EST_EWMA_COUNT];
+    DDSketch window[EST_WINDOW_COUNT];
+    int16_t  ring[EST_RING_SLOTS];      // bin of each sample still in some window
+    uint8_t  seen;                      // EWMAs start at the first value, not at 0
+} FieldEstimator;
+
+static FieldEstimator g_est[STAT_FIELD_MAX];
+
+/*
+ * Sample timestamps are shared by every field: the ring is written once
+ * per update, and each window keeps its own tail into it.
+ */
+static uint64_t g_ring_ts[EST_RING_SLOTS];
+static unsigned g_ring_head = 0;        // next slot to write
+static unsigned g_ring_size = 0;
+static unsigned g_tail[EST_WINDOW_COUNT];
+static unsigned g_window_len[EST_WINDOW_COUNT];
+
+static uint64_t g_last_ns = 0;
+static int      g_have_sample = 0;
+
+static double g_gamma = 0.0;
+static double g_inv_ln_gamma = 0.0;
+
+/* =======================
+ * DDSketch
+ * ======================= */
+
+static void dds_init_constants(void) {
+    if (g_gamma != 0.0) return;
+    g_gamma = (1.0 + DDS_RELATIVE_ACCURACY) / (1.0 - DDS_RELATIVE_ACCURACY);
+    g_inv_ln_gamma = 1.0 / log(g_gamma);
+}
+
+// midpoint (in relative terms) of a bin's value range
+static double dds_value(int bin) {
+    if (bin <= 0) return 0.0;
+    return DDS_MIN_VALUE * 2.0 * pow(g_gamma, bin - 1) / (g_gamma + 1.0);
+}
+
+int ddsketch_bin(double v) {
+    dds_init_constants();
+    if (!(v >= DDS_MIN_VALUE)) return 0;    // also catches NaN
+    double k = ceil(log(v / DDS_MIN_VALUE) * g_inv_ln_gamma);
+    if (k > DDS_BINS - 2) return DDS_BINS - 1;
+    return 1 + (int)k;
+}
+
+void ddsketch_clear(DDSketch* d) {
+    memset(d, 0, sizeof(*d));
+}
+
+void ddsketch_add_bin(DDSketch* d, int bin) {
+    d->bins[bin]++;
+    d->count++;
+}
+
+void ddsketch_remove_bin(DDSketch* d, int bin) {
+    if (d->bins[bin] == 0) return;
+    d->bins[bin]--;
+    d->count--;
+}
+
+void ddsketch_merge(DDSketch* dst, const DDSketch* src) {
+    for (int b = 0; b < DDS_BINS; b++) {
+        uint32_t sum = (uint32_t)dst->bins[b] + src->bins[b];
+        dst->bins[b] = sum > UINT16_MAX ? UINT16_MAX : (uint16_t)sum;
+    }
+    dst->count += src->count;
+}
+
+void ddsketch_quantiles(const DDSketch* d, const double* qs, double* out, size_t n) {
+    dds_init_constants();
+
+    if (d->count == 0) {
+        for (size_t i = 0; i < n; i++) out[i] = 0.0;
+        return;
+    }
+
+    size_t i = 0;
+    uint64_t seen = 0;
+    for (int b = 0; b < DDS_BINS && i < n; b++) {
+        seen += d->bins[b];
+        while (i < n && (double)seen > qs[i] * (double)(d->count - 1)) {
+            out[i++] = dds_value(b);
+        }
+    }
+    while (i < n) out[i++] = dds_value(DDS_BINS - 1);   // saturated merge
+}
+
+/* =======================
+ * Helpers
+ * ======================= */
+
+static void evict_oldest(EstWindow w, size_t nfields) {
+    unsigned slot = g_tail[w];
+    for (size_t f = 0; f < nfields; f++) {
+        if (g_est[f].ring[slot] != NO_SAMPLE) ddsketch_remove_bin(&g_est[f].window[w], g_est[f].ring[slot]);
+    }
+    g_tail[w] = (slot + 1) % EST_RING_SLOTS;
+    g_window_len[w]--;
+}
+
+static int field_ok(int field, size_t* nfields) {
+    stat_fields(nfields);
+    return field >= 0 && (size_t)field < *nfields;
+}
+
+static void ingest(const HardwareStats* s, const unsigned char* present, uint64_t now_ns) {
+    size_t nfields;
+    const StatField* fields = stat_fields(&nfields);
+
+    // age samples out of each window
+    for (int w = 0; w < EST_WINDOW_COUNT; w++) {
+        while (g_window_len[w] > 0 && now_ns - g_ring_ts[g_tail[w]] >= g_window_ns[w]) {
+            evict_oldest((EstWindow)w, nfields);
+        }
+        // ring full: the slot about to be overwritten leaves every window still holding it
+        if (g_ring_size == EST_RING_SLOTS && g_window_len[w] > 0 && g_tail[w] == g_ring_head) {
+            evict_oldest((EstWindow)w, nfields);
+        }
+    }
+
+    double alpha[EST_EWMA_COUNT];
+    double dt = g_have_sample ? (double)(now_ns - g_last_ns) / 1e9 : 0.0;
+    for (int e = 0; e < EST_EWMA_COUNT; e++) alpha[e] = g_have_sample ? 1.0 - exp(-dt / g_ewma_tau_s[e]) : 1.0;
+
+    unsigned slot = g_ring_head;
+    g_ring_ts[slot] = now_ns;
+
+    for (size_t f = 0; f < nfields; f++) {
+        FieldEstimator* est = &g_est[f];
+        if (present && !present[f]) {
+            est->ring[slot] = NO_SAMPLE;
+            continue;
+        }
+        double v = stat_field_value(&fields[f], s);
+
+        for (int e = 0; e < EST_EWMA_COUNT; e++) est->ewma[e] += (est->seen ? alpha[e] : 1.0) * (v - est->ewma[e]);
+        est->seen = 1;
+
+        int bin = ddsketch_bin(v);
+        est->ring[slot] = (int16_t)bin;
+        for (int w = 0; w < EST_WINDOW_COUNT; w++) ddsketch_add_bin(&est->window[w], bin);
+    }
+
+    for (int w = 0; w < EST_WINDOW_COUNT; w++) {
+        if (g_window_len[w] == 0) g_tail[w] = slot;
+        g_window_len[w]++;
+    }
+
+    g_ring_head = (slot + 1) % EST_RING_SLOTS;
+    if (g_ring_size < EST_RING_SLOTS) g_ring_size++;
+
+    g_last_ns = now_ns;
+    g_have_sample = 1;
+}
+
+/* =======================
+ * Public API
+ * ======================= */
+
+void estimators_update(const HardwareStats* s, uint64_t now_ns) {
+    ingest(s, NULL, now_ns);
+}
+
+void estimators_update_partial(const HardwareStats* s, const unsigned char* present, uint64_t now_ns) {
+    ingest(s, present, now_ns);
+}
+
+double estimators_ewma(int field, EstEwma which) {
+    size_t n;
+    if (!field_ok(field, &n) || which < 0 || which >= EST_EWMA_COUNT) return 0.0;
+    return g_est[field].ewma[which];
+}
+
+void estimators_quantiles(int field, EstWindow window, EstQuantiles* out) {
+    static const double qs[3] = { 0.50, 0.95, 0.99 };
+    double v[3] = { 0.0, 0.0, 0.0 };
+    size_t n;
+
+    memset(out, 0, sizeof(*out));
+    if (!field_ok(field, &n) || window < 0 || window >= EST_WINDOW_COUNT) return;
+
+    const DDSketch* d = &g_est[field].window[window];
+    ddsketch_quantiles(d, qs, v, 3);
+    out->count = d->count;
+    out->p50 = v[0];
+    out->p95 = v[1];
+    out->p99 = v[2];
+}
+
+const DDSketch* estimators_sketch(int field, EstWindow window) {
+    size_t n;
+    if (!field_ok(field, &n) || window < 0 || window >= EST_WINDOW_COUNT) return NULL;
+    return &g_est[field].window[window];
+}
+
+void estimators_reset(void) {
+    memset(g_est, 0, sizeof(g_est));
+    memset(g_tail, 0, sizeof(g_tail));
+    memset(g_window_len, 0, sizeof(g_window_len));
+    g_ring_head = 0;
+    g_ring_size = 0;
+    g_have_sample = 0;
+}
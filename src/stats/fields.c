@@ -0,0 +1,115 @@
+#include "stats/fields.h"
+
+#include <string.h>
+
+/* =======================
+ * Field table
+ * ======================= */
+
+#define F(name, member, type) { name, offsetof(HardwareStats, member), type }
+
+#define PSI_FIELDS(label, kind) \
+    F("psi." label ".some10",  psi[kind].some_avg10,  STAT_DOUBLE), \
+    F("psi." label ".some60",  psi[kind].some_avg60,  STAT_DOUBLE), \
+    F("psi." label ".some300", psi[kind].some_avg300, STAT_DOUBLE), \
+    F("psi." label ".full10",  psi[kind].full_avg10,  STAT_DOUBLE), \
+    F("psi." label ".full60",  psi[kind].full_avg60,  STAT_DOUBLE), \
+    F("psi." label ".full300", psi[kind].full_avg300, STAT_DOUBLE)
+
+static const StatField g_fields[] = {
+    F("cpu",                 cpu_usage_percent,   STAT_DOUBLE),
+    F("mem.used_percent",    mem_used_percent,    STAT_DOUBLE),
+    F("mem.total",           mem_total_kb,        STAT_LONG),
+    F("mem.available",       mem_available_kb,    STAT_LONG),
+    F("mem.free",            mem_free_kb,         STAT_LONG),
+    F("mem.buffers",         mem_buffers_kb,      STAT_LONG),
+    F("mem.cached",          mem_cached_kb,       STAT_LONG),
+    F("mem.active",          mem_active_kb,       STAT_LONG),
+    F("mem.inactive",        mem_inactive_kb,     STAT_LONG),
+    F("mem.dirty",           mem_dirty_kb,        STAT_LONG),
+    F("mem.writeback",       mem_writeback_kb,    STAT_LONG),
+    F("mem.anon",            mem_anon_kb,         STAT_LONG),
+    F("mem.mapped",          mem_mapped_kb,       STAT_LONG),
+    F("mem.shmem",           mem_shmem_kb,        STAT_LONG),
+    F("mem.slab",            mem_slab_kb,         STAT_LONG),
+    F("mem.sreclaimable",    mem_sreclaimable_kb, STAT_LONG),
+    F("mem.sunreclaim",      mem_sunreclaim_kb,   STAT_LONG),
+    F("mem.kernel_stack",    mem_kernel_stack_kb, STAT_LONG),
+    F("mem.page_tables",     mem_page_tables_kb,  STAT_LONG),
+    F("mem.committed",       mem_committed_kb,    STAT_LONG),
+    F("mem.commit_limit",    mem_commit_limit_kb, STAT_LONG),
+    F("swap.total",          swap_total_kb,       STAT_LONG),
+    F("swap.free",           swap_free_kb,        STAT_LONG),
+    F("swap.cached",         swap_cached_kb,      STAT_LONG),
+
+    F("vm.pgfault",          pgfault_per_s,       STAT_DOUBLE),
+    F("vm.pgmajfault",       pgmajfault_per_s,    STAT_DOUBLE),
+    F("vm.pswpin",           pswpin_per_s,        STAT_DOUBLE),
+    F("vm.pswpout",          pswpout_per_s,       STAT_DOUBLE),
+    F("vm.pgpgin",           pgpgin_per_s,        STAT_DOUBLE),
+    F("vm.pgpgout",          pgpgout_per_s,       STAT_DOUBLE),
+    F("vm.pgsteal",          pgsteal_per_s,       STAT_DOUBLE),
+    F("vm.allocstall",       allocstall_per_s,    STAT_DOUBLE),
+    F("vm.oom_kill",         oom_kill_total,      STAT_ULL),
+
+    F("load1",               load1,               STAT_DOUBLE),
+    F("load5",               load5,               STAT_DOUBLE),
+    F("load15",              load15,              STAT_DOUBLE),
+    F("uptime",              uptime_seconds,      STAT_DOUBLE),
+    F("temp",                cpu_temp_c,          STAT_DOUBLE),
+
+    F("net.rx_bytes",        net_rx_bytes_per_s,   STAT_DOUBLE),
+    F("net.tx_bytes",        net_tx_bytes_per_s,   STAT_DOUBLE),
+    F("net.rx_packets",      net_rx_packets_per_s, STAT_DOUBLE),
+    F("net.tx_packets",      net_tx_packets_per_s, STAT_DOUBLE),
+    F("net.rx_errs",         net_rx_errs_per_s,    STAT_DOUBLE),
+    F("net.tx_errs",         net_tx_errs_per_s,    STAT_DOUBLE),
+    F("net.rx_drop",         net_rx_drop_per_s,    STAT_DOUBLE),
+    F("net.tx_drop",         net_tx_drop_per_s,    STAT_DOUBLE),
+
+    F("procs",               proc_count,          STAT_UINT),
+
+    PSI_FIELDS("cpu",    PSI_CPU),
+    PSI_FIELDS("memory", PSI_MEMORY),
+    PSI_FIELDS("io",     PSI_IO),
+
+    F("cgroup.count",        cgroup_count,                    STAT_UINT),
+    F("cgroup.top.cpu",      cgroup_top.cpu_percent,          STAT_DOUBLE),
+    F("cgroup.top.memory",   cgroup_top.memory_current,       STAT_ULL),
+    F("cgroup.top.io_read",  cgroup_top.io_read_bytes_per_s,  STAT_DOUBLE),
+    F("cgroup.top.io_write", cgroup_top.io_write_bytes_per_s, STAT_DOUBLE),
+
+    F("irq.total",           irq.irq_total_per_s,      STAT_DOUBLE),
+    F("irq.softirq",         irq.softirq_total_per_s,  STAT_DOUBLE),
+    F("irq.hottest",         irq.hottest_irq_per_s,    STAT_DOUBLE),
+    F("irq.imbalance",       irq.irq_imbalance,        STAT_DOUBLE),
+    F("irq.net_rx",          irq.net_rx_softirq_per_s, STAT_DOUBLE),
+    F("irq.net_rx_imbalance", irq.net_rx_imbalance,    STAT_DOUBLE),
+};
+
+#undef PSI_FIELDS
+#undef F
+
+_Static_assert(sizeof(g_fields) / sizeof(g_fields[0]) <= STAT_FIELD_MAX, "raise STAT_FIELD_MAX");
+
+/* =======================
+ * Public API
+ * ======================= */
+
+const StatField* stat_fields(size_t* count) {
+    if (count) *count = sizeof(g_fields) / sizeof(g_fields[0]);
+    return g_fields;
+}
+
+int stat_field_index(const char* name) {
+    if (!name) return -1;
+    for (size_t i = 0; i < sizeof(g_fields) / sizeof(g_fields[0]); i++) {
+        if (strcmp(g_fields[i].name, name) == 0) return (int)i;
+    }
+    return -1;
+}
+
+const StatField* stat_field_find(const char* name) {
+    int i = stat_field_index(name);
+    return i < 0 ? NULL : &g_fields[i];
+}
@@ -0,0 +1,206 @@
+#include "stream/decoder.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* =======================
+ * Internal structures
+ * ======================= */
+
+// anything longer is treated as corruption rather than buffered
+#define RECORD_MAX (1u << 20)
+
+struct StreamDecoder {
+    uint8_t* buf;
+    size_t   len, cap;
+
+    int      synced;            // inside a stream after a valid sync header
+    StreamField fields[STREAM_MAX_FIELDS];
+    size_t   field_count;       // 0 until a dictionary was seen
+    int      have_key;          // deltas need a keyframe to apply to
+    int64_t  prev[STREAM_MAX_FIELDS];
+    uint64_t prev_ms;
+    double   values[STREAM_MAX_FIELDS];
+    double   scale[STREAM_MAX_FIELDS];
+
+    uint64_t skipped;
+};
+
+/* =======================
+ * Helpers
+ * ======================= */
+
+static void lose_sync(StreamDecoder* d) {
+    d->synced = 0;
+    d->have_key = 0;
+}
+
+static int parse_dictionary(StreamDecoder* d, const uint8_t* p, size_t len) {
+    uint64_t n, name_len;
+    size_t off = stream_get_varint(p, len, &n);
+    if (!off || n == 0 || n > STREAM_MAX_FIELDS) return -1;
+
+    for (size_t i = 0; i < n; i++) {
+        size_t c = stream_get_varint(p + off, len - off, &name_len);
+        if (!c || name_len >= STREAM_NAME_MAX) return -1;
+        off += c;
+        if (len - off < name_len + 1) return -1;
+        memcpy(d->fields[i].name, p + off, name_len);
+        d->fields[i].name[name_len] = '\0';
+        off += name_len;
+        d->fields[i].decimals = p[off++];
+        double s = 1.0;
+        for (unsigned k = 0; k < d->fields[i].decimals; k++) s *= 10.0;
+        d->scale[i] = s;
+    }
+    if (off != len) return -1;
+    d->field_count = n;
+    d->have_key = 0;
+    return 0;
+}
+
+static int parse_values(StreamDecoder* d, const uint8_t* p, size_t len, int delta) {
+    uint64_t v;
+    int64_t  vals[STREAM_MAX_FIELDS];
+    size_t off = stream_get_varint(p, len, &v);
+    if (!off) return -1;
+    uint64_t t = delta ? d->prev_ms + (uint64_t)stream_unzigzag(v) : v;
+
+    for (size_t i = 0; i < d->field_count; i++) {
+        size_t c = stream_get_varint(p + off, len - off, &v);
+        if (!c) return -1;
+        off += c;
+        int64_t x = stream_unzigzag(v);
+        vals[i] = delta ? (int64_t)((uint64_t)d->prev[i] + (uint64_t)x) : x;
+    }
+    if (off != len) return -1;
+
+    memcpy(d->prev, vals, d->field_count * sizeof(*vals));
+    d->prev_ms = t;
+    d->have_key = 1;
+    for (size_t i = 0; i < d->field_count; i++) d->values[i] = (double)vals[i] / d->scale[i];
+    return 0;
+}
+
+// index of the next sync header candidate at or after from, or len
+static size_t find_magic(const StreamDecoder* d, size_t from) {
+    for (size_t i = from; i < d->len; i++) {
+        size_t n = d->len - i < STREAM_MAGIC_LEN ? d->len - i : STREAM_MAGIC_LEN;
+        if (!memcmp(d->buf + i, STREAM_MAGIC, n)) return i;
+    }
+    return d->len;
+}
+
+/*
+ * Consume as many whole units (sync headers, records) from the buffer as
+ * possible. Returns the number of bytes consumed.
+ */
+static size_t process(StreamDecoder* d, const StreamCallbacks* cb, void* ctx) {
+    size_t pos = 0;
+
+    while (pos < d->len) {
+        const uint8_t* p = d->buf + pos;
+        size_t avail = d->len - pos;
+
+        if (!d->synced) {
+            size_t at = find_magic(d, pos);
+            d->skipped += at - pos;
+            pos = at;
+            if (d->len - pos < STREAM_SYNC_LEN) break;
+            p = d->buf + pos;
+            if (p[STREAM_MAGIC_LEN] != STREAM_VERSION) {
+                // a newer stream (or a false match): look further
+                d->skipped++;
+                pos++;
+                continue;
+            }
+            d->synced = 1;
+            pos += STREAM_SYNC_LEN;
+            continue;
+        }
+
+        if (p[0] == STREAM_MAGIC[0]) {
+            if (avail < STREAM_SYNC_LEN) break;
+            if (!memcmp(p, STREAM_MAGIC, STREAM_MAGIC_LEN)) {
+                // a fresh header in the middle of a stream (writer restarted)
+                lose_sync(d);
+                continue;
+            }
+        }
+
+        uint64_t len;
+        size_t c = stream_get_varint(p + 1, avail - 1, &len);
+        if (!c) {
+            if (avail - 1 < STREAM_VARINT_MAX) break;
+            lose_sync(d);
+            continue;
+        }
+        if (len > RECORD_MAX) {
+            lose_sync(d);
+            continue;
+        }
+        if (avail < 1 + c + len) break;
+
+        const uint8_t* payload = p + 1 + c;
+        int rc = 0;
+        switch (p[0]) {
+        case STREAM_REC_DICTIONARY:
+            rc = parse_dictionary(d, payload, len);
+            if (!rc && cb && cb->on_fields) cb->on_fields(ctx, d->fields, d->field_count);
+            break;
+        case STREAM_REC_KEYFRAME:
+        case STREAM_REC_SAMPLE:
+            if (!d->field_count) break;
+            if (p[0] == STREAM_REC_SAMPLE && !d->have_key) break;
+            rc = parse_values(d, payload, len, p[0] == STREAM_REC_SAMPLE);
+            if (!rc && cb && cb->on_sample) cb->on_sample(ctx, d->prev_ms, d->values, d->field_count);
+            break;
+        default:
+            break;
+        }
+        if (rc < 0) {
+            d->field_count = 0;
+            lose_sync(d);
+        }
+        pos += 1 + c + len;
+    }
+    return pos;
+}
+
+/* =======================
+ * Public API
+ * ======================= */
+
+StreamDecoder* stream_decoder_new(void) {
+    return calloc(1, sizeof(StreamDecoder));
+}
+
+int stream_decoder_feed(StreamDecoder* d, const uint8_t* data, size_t len, const StreamCallbacks* cb, void* ctx) {
+    if (!d) return -1;
+
+    if (d->len + len > d->cap) {
+        size_t cap = d->cap ? d->cap : 4096;
+        while (cap < d->len + len) cap *= 2;
+        uint8_t* b = realloc(d->buf, cap);
+        if (!b) return -1;
+        d->buf = b;
+        d->cap = cap;
+    }
+    memcpy(d->buf + d->len, data, len);
+    d->len += len;
+
+    size_t used = process(d, cb, ctx);
+    memmove(d->buf, d->buf + used, d->len - used);
+    d->len -= used;
+    return 0;
+}
+
+uint64_t stream_decoder_skipped(const StreamDecoder* d) {
+    return d ? d->skipped : 0;
+}
+
+void stream_decoder_free(StreamDecoder* d) {
+    if (!d) return;
+    free(d->buf);
+    free(d);
+}
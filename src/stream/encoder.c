@@ -0,0 +1,265 @@
+#define _DEFAULT_SOURCE
+#include "stream/encoder.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+/* =======================
+ * Internal structures
+ * ======================= */
+
+/*
+ * A record's length prefix is only known once its payload is encoded, so
+ * prefixes and payloads go to two arenas and writev() gathers them in
+ * order; nothing is ever moved to make room for a prefix.
+ */
+#define BATCH_IOV        64
+#define PAYLOAD_ARENA    (64 * 1024)
+#define RECORD_PREFIX    (1 + STREAM_VARINT_MAX)
+#define PREFIX_ARENA     (BATCH_IOV * (RECORD_PREFIX + STREAM_SYNC_LEN))
+#define FLUSH_BYTES      (16 * 1024)
+#define FLUSH_AGE_NS     1000000000ull
+
+struct StreamWriter {
+    int      fd;
+    int      own_fd;
+
+    StreamField* fields;
+    size_t   field_count;
+    int64_t* prev;
+    uint64_t prev_ms;
+    unsigned since_keyframe;
+    int      need_keyframe;
+
+    struct iovec iov[BATCH_IOV];
+    int      iov_count;
+    uint8_t  prefix[PREFIX_ARENA];
+    size_t   prefix_used;
+    uint8_t* payload;
+    size_t   payload_used;
+    size_t   pending;
+    uint64_t first_pending_ns;
+
+    uint64_t written;
+};
+
+/* =======================
+ * Helpers
+ * ======================= */
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int write_all(StreamWriter* w) {
+    struct iovec* iov = w->iov;
+    int cnt = w->iov_count;
+
+    while (cnt > 0) {
+        ssize_t n = writev(w->fd, iov, cnt);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        w->written += (uint64_t)n;
+        while (cnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= (ssize_t)iov->iov_len;
+            iov++;
+            cnt--;
+        }
+        if (cnt > 0) {
+            iov->iov_base = (uint8_t*)iov->iov_base + n;
+            iov->iov_len -= (size_t)n;
+        }
+    }
+    return 0;
+}
+
+// room for a keyframe (sync, dictionary, keyframe: 4 iovecs) or a sample in the current batch
+static int reserve(StreamWriter* w, size_t payload_max) {
+    if (w->iov_count + 4 > BATCH_IOV ||
+        w->prefix_used + 2 * RECORD_PREFIX + STREAM_SYNC_LEN > PREFIX_ARENA ||
+        w->payload_used + payload_max > PAYLOAD_ARENA)
+        return stream_writer_flush(w);
+    return 0;
+}
+
+static void push(StreamWriter* w, const void* base, size_t len) {
+    // adjacent pieces of the same arena merge into one iovec
+    struct iovec* last = w->iov_count ? &w->iov[w->iov_count - 1] : NULL;
+    if (last && (const uint8_t*)last->iov_base + last->iov_len == (const uint8_t*)base) {
+        last->iov_len += len;
+    } else {
+        w->iov[w->iov_count].iov_base = (void*)base;
+        w->iov[w->iov_count].iov_len = len;
+        w->iov_count++;
+    }
+    if (!w->pending) w->first_pending_ns = mono_ns();
+    w->pending += len;
+}
+
+static void push_sync(StreamWriter* w) {
+    uint8_t* p = w->prefix + w->prefix_used;
+    memcpy(p, STREAM_MAGIC, STREAM_MAGIC_LEN);
+    p[STREAM_MAGIC_LEN] = STREAM_VERSION;
+    p[STREAM_MAGIC_LEN + 1] = 0;
+    w->prefix_used += STREAM_SYNC_LEN;
+    push(w, p, STREAM_SYNC_LEN);
+}
+
+// the payload was encoded at payload + payload_used; prefix it and queue both
+static void push_record(StreamWriter* w, uint8_t type, size_t len) {
+    uint8_t* p = w->prefix + w->prefix_used;
+    size_t n = 0;
+    p[n++] = type;
+    n += stream_put_varint(p + n, len);
+    w->prefix_used += n;
+    push(w, p, n);
+    push(w, w->payload + w->payload_used, len);
+    w->payload_used += len;
+}
+
+static size_t dictionary_max(const StreamWriter* w) {
+    size_t max = STREAM_VARINT_MAX;
+    for (size_t i = 0; i < w->field_count; i++)
+        max += 2 + strlen(w->fields[i].name) + 1;
+    return max;
+}
+
+static void encode_dictionary(StreamWriter* w) {
+    uint8_t* p = w->payload + w->payload_used;
+    size_t n = stream_put_varint(p, w->field_count);
+
+    for (size_t i = 0; i < w->field_count; i++) {
+        size_t len = strlen(w->fields[i].name);
+        n += stream_put_varint(p + n, len);
+        memcpy(p + n, w->fields[i].name, len);
+        n += len;
+        p[n++] = w->fields[i].decimals;
+    }
+    push_record(w, STREAM_REC_DICTIONARY, n);
+}
+
+/* =======================
+ * Public API
+ * ======================= */
+
+StreamWriter* stream_writer_fdopen(int fd) {
+    StreamWriter* w = calloc(1, sizeof(*w));
+    if (!w) return NULL;
+    w->payload = malloc(PAYLOAD_ARENA);
+    if (!w->payload) {
+        free(w);
+        return NULL;
+    }
+    w->fd = fd;
+    w->need_keyframe = 1;
+    return w;
+}
+
+StreamWriter* stream_writer_open(const char* path) {
+    if (!path || !strcmp(path, "-")) return stream_writer_fdopen(STDOUT_FILENO);
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) return NULL;
+
+    StreamWriter* w = stream_writer_fdopen(fd);
+    if (!w) {
+        close(fd);
+        return NULL;
+    }
+    w->own_fd = 1;
+    return w;
+}
+
+int stream_writer_set_fields(StreamWriter* w, const StreamField* fields, size_t n) {
+    if (!w || !fields || !n || n > STREAM_MAX_FIELDS) return -1;
+
+    StreamField* f = malloc(n * sizeof(*f));
+    int64_t* prev = calloc(n, sizeof(*prev));
+    if (!f || !prev) {
+        free(f);
+        free(prev);
+        return -1;
+    }
+    memcpy(f, fields, n * sizeof(*f));
+    for (size_t i = 0; i < n; i++) f[i].name[STREAM_NAME_MAX - 1] = '\0';
+
+    free(w->fields);
+    free(w->prev);
+    w->fields = f;
+    w->prev = prev;
+    w->field_count = n;
+    w->need_keyframe = 1;
+    return 0;
+}
+
+int stream_writer_sample(StreamWriter* w, uint64_t unix_ms, const int64_t* values) {
+    if (!w || !w->field_count) return -1;
+
+    int key = w->need_keyframe || w->since_keyframe >= STREAM_KEYFRAME_EVERY ||
+              unix_ms < w->prev_ms;
+    size_t max = (w->field_count + 1) * STREAM_VARINT_MAX;
+    if (key) max += dictionary_max(w);
+    if (reserve(w, max) < 0) return -1;
+
+    uint8_t* p;
+    size_t n = 0;
+    if (key) {
+        push_sync(w);
+        encode_dictionary(w);
+        p = w->payload + w->payload_used;
+        n += stream_put_varint(p, unix_ms);
+        for (size_t i = 0; i < w->field_count; i++)
+            n += stream_put_varint(p + n, stream_zigzag(values[i]));
+        push_record(w, STREAM_REC_KEYFRAME, n);
+        w->since_keyframe = 0;
+        w->need_keyframe = 0;
+    } else {
+        p = w->payload + w->payload_used;
+        n += stream_put_varint(p, stream_zigzag((int64_t)(unix_ms - w->prev_ms)));
+        for (size_t i = 0; i < w->field_count; i++)
+            n += stream_put_varint(p + n, stream_zigzag((int64_t)((uint64_t)values[i] - (uint64_t)w->prev[i])));
+        push_record(w, STREAM_REC_SAMPLE, n);
+        w->since_keyframe++;
+    }
+    memcpy(w->prev, values, w->field_count * sizeof(*values));
+    w->prev_ms = unix_ms;
+
+    if (w->pending >= FLUSH_BYTES || mono_ns() - w->first_pending_ns >= FLUSH_AGE_NS)
+        return stream_writer_flush(w);
+    return 0;
+}
+
+int stream_writer_flush(StreamWriter* w) {
+    if (!w) return -1;
+    int rc = write_all(w);
+    w->iov_count = 0;
+    w->prefix_used = 0;
+    w->payload_used = 0;
+    w->pending = 0;
+    // a partially written batch leaves the reader mid-record; restart clean
+    if (rc < 0) w->need_keyframe = 1;
+    return rc;
+}
+
+uint64_t stream_writer_bytes(const StreamWriter* w) {
+    return w ? w->written : 0;
+}
+
+void stream_writer_close(StreamWriter* w) {
+    if (!w) return;
+    stream_writer_flush(w);
+    if (w->own_fd) close(w->fd);
+    free(w->fields);
+    free(w->prev);
+    free(w->payload);
+    free(w);
+}
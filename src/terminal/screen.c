@@ -0,0 +1,213 @@
+#define _DEFAULT_SOURCE
+#include "terminal/screen.h"
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+/* =======================
+ * Internal structures
+ * ======================= */
+
+// unchanged runs shorter than this are re-sent instead of paying for a cursor move
+#define SCREEN_MERGE_GAP 6
+
+struct Screen {
+    int fd;
+    int rows, cols;
+
+    char* cur;      // rows * cols, frame being composed
+    char* prev;     // what the terminal shows now
+    char* out;      // escape sequences + text of one frame
+    size_t out_cap;
+
+    int full_redraw;
+};
+
+/* =======================
+ * Helpers
+ * ======================= */
+
+static void query_size(int fd, int* rows, int* cols) {
+    struct winsize ws;
+    if (ioctl(fd, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0 && ws.ws_col > 0) {
+        *rows = ws.ws_row;
+        *cols = ws.ws_col;
+    } else {
+        *rows = 24;     // serial consoles often report 0x0
+        *cols = 80;
+    }
+}
+
+static int write_all(int fd, const char* p, size_t n) {
+    while (n > 0) {
+        ssize_t w = write(fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += w;
+        n -= (size_t)w;
+    }
+    return 0;
+}
+
+static int resize(Screen* scr, int rows, int cols) {
+    size_t cells = (size_t)rows * (size_t)cols;
+    // worst case per cell stays under 3 bytes with span merging, plus one cursor move per row
+    size_t out_cap = cells * 3 + (size_t)rows * 16 + 64;
+
+    char* cur  = malloc(cells);
+    char* prev = malloc(cells);
+    char* out  = malloc(out_cap);
+    if (!cur || !prev || !out) {
+        free(cur); free(prev); free(out);
+        return -1;
+    }
+
+    free(scr->cur); free(scr->prev); free(scr->out);
+    scr->cur = cur;
+    scr->prev = prev;
+    scr->out = out;
+    scr->out_cap = out_cap;
+    scr->rows = rows;
+    scr->cols = cols;
+    scr->full_redraw = 1;
+    return 0;
+}
+
+static size_t append(Screen* scr, size_t len, const char* s, size_t n) {
+    memcpy(scr->out + len, s, n);
+    return len + n;
+}
+
+static size_t append_move(Screen* scr, size_t len, int row, int col) {
+    int n = snprintf(scr->out + len, scr->out_cap - len, "\x1b[%d;%dH", row + 1, col + 1);
+    return len + (size_t)n;
+}
+
+/* =======================
+ * Public API
+ * ======================= */
+
+int screen_init(Screen** out, int fd) {
+    if (!out) return -1;
+
+    Screen* scr = calloc(1, sizeof(*scr));
+    if (!scr) return -1;
+    scr->fd = fd;
+
+    int rows, cols;
+    query_size(fd, &rows, &cols);
+    if (resize(scr, rows, cols) != 0) { free(scr); return -1; }
+
+    // alternate screen, hide cursor
+    static const char enter[] = "\x1b[?1049h\x1b[?25l";
+    write_all(fd, enter, sizeof(enter) - 1);
+
+    *out = scr;
+    return 0;
+}
+
+void screen_deinit(Screen* scr) {
+    if (!scr) return;
+    static const char leave[] = "\x1b[0m\x1b[?25h\x1b[?1049l";
+    write_all(scr->fd, leave, sizeof(leave) - 1);
+    free(scr->cur);
+    free(scr->prev);
+    free(scr->out);
+    free(scr);
+}
+
+void screen_begin_frame(Screen* scr) {
+    int rows, cols;
+    query_size(scr->fd, &rows, &cols);
+    if (rows != scr->rows || cols != scr->cols) {
+        if (resize(scr, rows, cols) != 0) scr->full_redraw = 1; // keep the old geometry
+    }
+    memset(scr->cur, ' ', (size_t)scr->rows * (size_t)scr->cols);
+}
+
+int screen_rows(const Screen* scr) { return scr->rows; }
+int screen_cols(const Screen* scr) { return scr->cols; }
+
+void screen_put(Screen* scr, int row, int col, const char* text) {
+    if (row < 0 || row >= scr->rows || col < 0 || col >= scr->cols || !text) return;
+    char* dst = &scr->cur[(size_t)row * (size_t)scr->cols];
+    for (int c = col; c < scr->cols && *text; c++, text++) {
+        unsigned char ch = (unsigned char)*text;
+        dst[c] = (ch >= 0x20 && ch < 0x7f) ? (char)ch : '?';
+    }
+}
+
+void screen_printf(Screen* scr, int row, int col, const char* fmt, ...) {
+    char line[512];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    screen_put(scr, row, col, line);
+}
+
+void screen_bar(Screen* scr, int row, int col, int width, double percent) {
+    if (width < 3) return;
+    char bar[256];
+    int inner = width - 2;
+    if (inner > (int)sizeof(bar) - 3) inner = (int)sizeof(bar) - 3;
+
+    if (percent < 0.0) percent = 0.0;
+    if (percent > 100.0) percent = 100.0;
+    int filled = (int)(percent / 100.0 * inner + 0.5);
+
+    bar[0] = '[';
+    for (int i = 0; i < inner; i++) bar[1 + i] = (i < filled) ? '#' : '.';
+    bar[inner + 1] = ']';
+    bar[inner + 2] = '\0';
+    screen_put(scr, row, col, bar);
+}
+
+void screen_invalidate(Screen* scr) {
+    scr->full_redraw = 1;
+}
+
+int screen_flush(Screen* scr) {
+    size_t len = 0;
+    int cols = scr->cols;
+
+    if (scr->full_redraw) {
+        static const char clear[] = "\x1b[H\x1b[2J";
+        len = append(scr, len, clear, sizeof(clear) - 1);
+        // every cell differs from a 0 byte, so the diff below repaints all of it
+        memset(scr->prev, 0, (size_t)scr->rows * (size_t)cols);
+        scr->full_redraw = 0;
+    }
+
+    for (int r = 0; r < scr->rows; r++) {
+        const char* cur = &scr->cur[(size_t)r * (size_t)cols];
+        char* prev = &scr->prev[(size_t)r * (size_t)cols];
+
+        int c = 0;
+        while (c < cols) {
+            if (cur[c] == prev[c]) { c++; continue; }
+
+            int start = c, end = c + 1, gap = 0;
+            for (int k = c + 1; k < cols && gap < SCREEN_MERGE_GAP; k++) {
+                if (cur[k] != prev[k]) { end = k + 1; gap = 0; }
+                else gap++;
+            }
+
+            len = append_move(scr, len, r, start);
+            len = append(scr, len, cur + start, (size_t)(end - start));
+            memcpy(prev + start, cur + start, (size_t)(end - start));
+            c = end;
+        }
+    }
+
+    if (len == 0) return 0;
+    if (write_all(scr->fd, scr->out, len) != 0) return -1;
+    return (int)len;
+}
@@ -0,0 +1,114 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "stream/decoder.h"
+
+/*
+ * hw_stream_decode [--csv|--json] [FILE]
+ *
+ * hw_monitoring_program --stream çıktısını CSV'ye (varsayılan) ya da satır
+ * başına bir JSON nesnesine çevirir. FILE yoksa stdin okunur; FIFO ve
+ * yarıda kesilmiş dosyalar da olur, ilk anahtar kareden itibaren çözülür.
+ */
+
+typedef struct {
+    int json;
+    int have_fields;
+    size_t count;
+    // kendi kopyamız: çözücü sözlük dizisini yerinde yeniden yazar
+    StreamField fields[STREAM_MAX_FIELDS];
+} Output;
+
+static void on_fields(void* ctx, const StreamField* fields, size_t n) {
+    Output* o = ctx;
+
+    // anahtar karede aynı sözlük tekrar gelir; CSV başlığını yalnızca değişince bas
+    int same = o->have_fields && o->count == n;
+    for (size_t i = 0; same && i < n; i++)
+        same = !strcmp(o->fields[i].name, fields[i].name) && o->fields[i].decimals == fields[i].decimals;
+
+    memcpy(o->fields, fields, n * sizeof(*fields));
+    o->count = n;
+    o->have_fields = 1;
+    if (same || o->json) return;
+
+    printf("time_ms");
+    for (size_t i = 0; i < n; i++) printf(",%s", fields[i].name);
+    printf("\n");
+}
+
+static void on_sample(void* ctx, uint64_t unix_ms, const double* values, size_t n) {
+    Output* o = ctx;
+
+    if (o->json) {
+        printf("{\"time_ms\":%llu", (unsigned long long)unix_ms);
+        for (size_t i = 0; i < n; i++)
+            printf(",\"%s\":%.*f", o->fields[i].name, (int)o->fields[i].decimals, values[i]);
+        printf("}\n");
+    } else {
+        printf("%llu", (unsigned long long)unix_ms);
+        for (size_t i = 0; i < n; i++) printf(",%.*f", (int)o->fields[i].decimals, values[i]);
+        printf("\n");
+    }
+}
+
+int main(int argc, char** argv) {
+    Output o = {0};
+    const char* path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) o.json = 1;
+        else if (strcmp(argv[i], "--csv") == 0) o.json = 0;
+        else if (argv[i][0] == '-' && argv[i][1]) {
+            fprintf(stderr, "usage: %s [--csv|--json] [FILE]\n", argv[0]);
+            return 2;
+        } else path = argv[i];
+    }
+
+    // fread() 64K dolana kadar bekler; canlı FIFO için read()
+    int in = STDIN_FILENO;
+    if (path && strcmp(path, "-") != 0) {
+        in = open(path, O_RDONLY);
+        if (in < 0) {
+            perror(path);
+            return 1;
+        }
+    }
+
+    StreamDecoder* d = stream_decoder_new();
+    if (!d) return 1;
+
+    StreamCallbacks cb = { on_fields, on_sample };
+    uint8_t buf[64 * 1024];
+    ssize_t n;
+    int rc = 0;
+
+    while ((n = read(in, buf, sizeof(buf))) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("read");
+            rc = 1;
+            break;
+        }
+        if (stream_decoder_feed(d, buf, (size_t)n, &cb, &o) != 0) {
+            rc = 1;
+            break;
+        }
+        // canlı okurken satırlar beklemesin
+        fflush(stdout);
+    }
+
+    if (stream_decoder_skipped(d))
+        fprintf(stderr, "%llu bytes skipped while resynchronising\n",
+                (unsigned long long)stream_decoder_skipped(d));
+
+    stream_decoder_free(d);
+    if (in != STDIN_FILENO) close(in);
+    return rc;
+}
@@ -1,8 +1,33 @@
+#define _DEFAULT_SOURCE
 #include <stdio.h>
 #include "hardware_stats.h"
 #include "utility.h"
+#include "diag/self_stats.h"
+#include "terminal/screen.h"
+#include "stats/estimators.h"
+#include "stats/fields.h"
+#include "alerts/rules.h"
+#include "sched/scheduler.h"
+#include "collectors/cpu_burst.h"
+#include "fleet/aggregator.h"
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
 #include <unistd.h>
 
+#define DASH_FRAME_MS   100     // 10 Hz redraw
+#define DASH_CORE_CELL  24      // "cpu12  [##########] 100%" + gap
+
+static volatile sig_atomic_t g_dash_stop = 0;
+
+static void on_dash_signal(int sig){
+
+    (void)sig;
+    g_dash_stop = 1;
+
+}
+
 static void print_stats(HardwareStats* s){
 
     double used_memory_in_mb  = (s->mem_total_kb - s->mem_available_kb) / 1024.0;
@@ -16,21 +41,381 @@ static void print_stats(HardwareStats* s){
     printf("--------------------------------------------------\n");
     printf("CPU Usage   : %5.1f %%\n", s->cpu_usage_percent);
     printf("Memory      : %6.1f / %6.1f MB (used/total)\n", used_memory_in_mb, total_memory_in_mb);
+    printf("Mem detail  : cached %.1f  buffers %.1f  dirty %.1f  writeback %.1f  slab %.1f  shmem %.1f MB\n",
+           s->mem_cached_kb / 1024.0, s->mem_buffers_kb / 1024.0, s->mem_dirty_kb / 1024.0,
+           s->mem_writeback_kb / 1024.0, s->mem_slab_kb / 1024.0, s->mem_shmem_kb / 1024.0);
+    printf("Swap        : %6.1f / %6.1f MB (used/total)  in %.0f/s  out %.0f/s\n",
+           (s->swap_total_kb - s->swap_free_kb) / 1024.0, s->swap_total_kb / 1024.0, s->pswpin_per_s, s->pswpout_per_s);
+    printf("Faults      : %.0f/s  major %.0f/s  oom kills %llu\n", s->pgfault_per_s, s->pgmajfault_per_s, s->oom_kill_total);
     printf("Load Average: %.2f  %.2f  %.2f\n", s->load1, s->load5, s->load15);
     printf("Uptime      : %02d:%02d:%02d\n", hours, mins, secs);
-    
+
     if(s->cpu_temp_c > 0.0) printf("CPU Temp    : %.1f C\n", s->cpu_temp_c);
 
     else printf("CPU Temp    : N/A\n");
 
+    if(s->net_iface[0] != '\0'){
+
+        printf("Network     : %s  rx %.1f KB/s (%.0f pkt/s)  tx %.1f KB/s (%.0f pkt/s)\n",
+               s->net_iface, s->net_rx_bytes_per_s / 1024.0, s->net_rx_packets_per_s,
+               s->net_tx_bytes_per_s / 1024.0, s->net_tx_packets_per_s);
+        printf("Net errs    : rx %.0f/s tx %.0f/s  drops rx %.0f/s tx %.0f/s  (%u ifaces)\n",
+               s->net_rx_errs_per_s, s->net_tx_errs_per_s, s->net_rx_drop_per_s, s->net_tx_drop_per_s,
+               s->net_iface_count);
+
+    }
+
+    else printf("Network     : N/A\n");
+
+    printf("Interrupts  : %.0f/s  softirqs %.0f/s  net_rx %.0f/s (imbalance %.2f)\n",
+           s->irq.irq_total_per_s, s->irq.softirq_total_per_s, s->irq.net_rx_softirq_per_s, s->irq.net_rx_imbalance);
+
+    if(s->irq.hottest_irq[0] != '\0'){
+
+        printf("Hottest IRQ : %s %.0f/s mostly on CPU%d  (device irq imbalance %.2f)\n",
+               s->irq.hottest_irq, s->irq.hottest_irq_per_s, s->irq.hottest_irq_cpu, s->irq.irq_imbalance);
+
+    }
+
+    static const char* const psi_names[PSI_COUNT] = {"cpu", "memory", "io"};
+
+    for(int i = 0; i < PSI_COUNT; i++){
+
+        const PsiResource* r = &s->psi[i];
+
+        if(!r->available) continue;
+
+        printf("PSI %-8s: some %5.2f %5.2f %5.2f  full %5.2f %5.2f %5.2f\n", psi_names[i],
+               r->some_avg10, r->some_avg60, r->some_avg300, r->full_avg10, r->full_avg60, r->full_avg300);
+
+    }
+
+    if(s->cgroup_count > 0){
+
+        const CgroupStats* c = &s->cgroup_top;
+
+        printf("Cgroups     : %u tracked, busiest %s %.1f %%  mem %.1f MB  io r %.1f w %.1f KB/s  oom_kill %llu\n",
+               s->cgroup_count, c->name, c->cpu_percent, (double)c->memory_current / (1024.0 * 1024.0),
+               c->io_read_bytes_per_s / 1024.0, c->io_write_bytes_per_s / 1024.0, c->oom_kill);
+
+    }
+
+    printf("Processes   : %u\n", s->proc_count);
+
+    for(unsigned i = 0; i < s->top_proc_count; i++){
+
+        const ProcTopEntry* p = &s->top_procs[i];
+        printf("  %7d %-16s %6.1f %%  %8ld KB\n", p->pid, p->comm, p->cpu_percent, p->rss_kb);
+
+    }
+
     printf("--------------------------------------------------\n");
 }
 
 
+static void sleep_ms(long ms){
 
-int display_stats_only_terminal(HardwareStats* s){
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+
+}
+
+static double percent_of(unsigned long long part, unsigned long long total){
+
+    return total ? 100.0 * (double)part / (double)total : 0.0;
+
+}
+
+static int draw_trends(Screen* scr, int r){
+
+    static const char* const names[] = {
+        "cpu", "mem.used_percent", "load1", "net.rx_bytes", "net.tx_bytes",
+        "psi.cpu.some10", "psi.memory.some10", "psi.io.some10", "irq.total",
+    };
+
+    static int index[sizeof(names) / sizeof(names[0])];
+    static int resolved = 0;
+
+    if(!resolved){
+
+        for(size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) index[i] = stat_field_index(names[i]);
+        resolved = 1;
+
+    }
+
+    screen_printf(scr, r++, 0, "%-18s %10s %10s %10s   %10s %10s %10s   %10s",
+                  "TREND", "ewma 10s", "1m", "5m", "p50 1m", "p95 1m", "p99 1m", "p99 5m");
+
+    for(size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++){
+
+        EstQuantiles q1, q5;
+        estimators_quantiles(index[i], EST_WINDOW_1M, &q1);
+        estimators_quantiles(index[i], EST_WINDOW_5M, &q5);
+
+        screen_printf(scr, r++, 0, "%-18s %10.2f %10.2f %10.2f   %10.2f %10.2f %10.2f   %10.2f", names[i],
+                      estimators_ewma(index[i], EST_EWMA_10S), estimators_ewma(index[i], EST_EWMA_1M),
+                      estimators_ewma(index[i], EST_EWMA_5M), q1.p50, q1.p95, q1.p99, q5.p99);
+
+    }
+
+    return r;
+}
+
+// per-core busy % over short slices from the burst sampler, plus what sampling costs
+static int draw_burst(Screen* scr, int r, int cols){
+
+    CpuBurstWindow w;
+
+    if(!cpu_burst_running() || cpu_burst_latest(&w) != 0) return r;
+
+    CpuBurstOverhead oh;
+    cpu_burst_overhead(&oh);
+
+    screen_printf(scr, r++, 0, "BURST %u ms slices  %u Hz target, %u Hz in budget, %.0f Hz actual  sampler %.2f %% + consumer %.2f %% of a core  read %.1f us  dropped %llu  missed %llu",
+                  w.slice_ms, oh.target_hz, oh.effective_hz, oh.actual_hz, oh.sampler_cpu_percent, oh.consumer_cpu_percent, oh.read_us,
+                  (unsigned long long)oh.dropped, (unsigned long long)oh.missed_ticks);
+
+    // "cpu12 p50 100 p99 100 max 100" cells
+    int cell = 32;
+    int per_row = cols / cell;
+    if(per_row < 1) per_row = 1;
+
+    for(unsigned c = 0; c < w.core_count; c++){
+
+        const CpuBurstCore* k = &w.core[c];
+        screen_printf(scr, r + (int)(c / (unsigned)per_row), (int)(c % (unsigned)per_row) * cell,
+                      "cpu%-3u p50%4.0f p99%4.0f max%4.0f", c, k->p50, k->p99, k->max);
+
+    }
+
+    if(w.core_count > 0) r += (int)((w.core_count + (unsigned)per_row - 1) / (unsigned)per_row);
+
+    return r + 1;
+}
+
+// current interval of every adaptively scheduled collector
+static void draw_schedule(Screen* scr, int r){
+
+    SchedulerStatus sched[SCHEDULER_MAX_SOURCES];
+    size_t nsched = scheduler_status(sched, SCHEDULER_MAX_SOURCES);
+
+    char line[512];
+    int len = snprintf(line, sizeof(line), "sched");
+
+    for(size_t i = 0; i < nsched && len < (int)sizeof(line); i++){
+
+        len += snprintf(line + len, sizeof(line) - (size_t)len, "  %s %ums", sched[i].name, sched[i].interval_ms);
+
+    }
+
+    screen_put(scr, r, 0, line);
+}
+
+// --fleet-listen: what the rest of the fleet is doing, best first per ranking
+static int draw_fleet(Screen* scr, int r, int cols){
+
+    FleetView v;
+
+    if(fleet_aggregator_view(&v) != 0) return r;
+
+    screen_printf(scr, r++, 0, "FLEET udp/%u  %u nodes (%u stale)  %.0f datagrams/s  %.1f per recvmmsg  lost %llu  bad %llu",
+                  fleet_aggregator_port(), v.nodes, v.stale, v.datagrams_per_s, v.batch_mean,
+                  (unsigned long long)v.lost, (unsigned long long)v.bad);
+
+    static const char* const rank_names[FLEET_RANK_COUNT] = {"hottest", "core", "cpu", "mem"};
+    static const char* const rank_units[FLEET_RANK_COUNT] = {"C", "%", "%", "%"};
+
+    int cell = 28;
+
+    for(int k = 0; k < FLEET_RANK_COUNT; k++){
+
+        screen_printf(scr, r, 0, "  %-7s", rank_names[k]);
+
+        for(unsigned i = 0; i < v.top_count[k] && 10 + (int)(i + 1) * cell <= cols; i++){
+
+            const FleetEntry* e = &v.top[k][i];
+            char where[12] = "";
+            if(k == FLEET_RANK_CORE) snprintf(where, sizeof(where), " cpu%u", e->core);
+
+            screen_printf(scr, r, 10 + (int)i * cell, "%-12.12s%s %5.1f%s", e->node, where, e->value, rank_units[k]);
+
+        }
+
+        r++;
+
+    }
+
+    return r + 1;
+}
+
+/*
+ * One frame of the dashboard, laid out top to bottom. The screen clips
+ * anything that does not fit, so a small terminal just loses the tail.
+ */
+static void draw_dashboard(Screen* scr, const HardwareStats* s){
 
-    while(1){
+    int cols = screen_cols(scr);
+    int r = 0;
+
+    int hours = (int)(s->uptime_seconds / 3600);
+    int mins  = (int)((s->uptime_seconds - hours * 3600) / 60);
+    int secs  = (int)((s->uptime_seconds - hours * 3600 - mins * 60));
+
+    char temp[16];
+    if(s->cpu_temp_c > 0.0) snprintf(temp, sizeof(temp), "%.1f C", s->cpu_temp_c);
+    else snprintf(temp, sizeof(temp), "N/A");
+
+    screen_printf(scr, r++, 0, "hw-monitoring   up %02d:%02d:%02d   load %.2f %.2f %.2f   temp %s   procs %u",
+                  hours, mins, secs, s->load1, s->load5, s->load15, temp, s->proc_count);
+    r++;
+
+    // --- totals ---
+    screen_put(scr, r, 0, "CPU");
+    screen_bar(scr, r, 6, 32, s->cpu_usage_percent);
+    screen_printf(scr, r++, 39, "%5.1f %%  %u cores", s->cpu_usage_percent, s->core_count);
+
+    unsigned long long mem_used = s->mem_total_kb - s->mem_available_kb;
+    double mem_pct = s->mem_used_percent;
+    screen_put(scr, r, 0, "MEM");
+    screen_bar(scr, r, 6, 32, mem_pct);
+    screen_printf(scr, r++, 39, "%5.1f %%  %.0f / %.0f MB  cached %.0f  dirty %.1f  slab %.0f MB",
+                  mem_pct, mem_used / 1024.0, s->mem_total_kb / 1024.0,
+                  s->mem_cached_kb / 1024.0, s->mem_dirty_kb / 1024.0, s->mem_slab_kb / 1024.0);
+
+    double swap_pct = percent_of(s->swap_total_kb - s->swap_free_kb, s->swap_total_kb);
+    screen_put(scr, r, 0, "SWAP");
+    screen_bar(scr, r, 6, 32, swap_pct);
+    screen_printf(scr, r++, 39, "%5.1f %%  in %.0f/s out %.0f/s  faults %.0f/s major %.0f/s  oom %llu",
+                  swap_pct, s->pswpin_per_s, s->pswpout_per_s, s->pgfault_per_s, s->pgmajfault_per_s,
+                  s->oom_kill_total);
+    r++;
+
+    // --- per-subsystem lines ---
+    if(s->net_iface[0] != '\0'){
+
+        screen_printf(scr, r++, 0, "NET   %-8s rx %8.1f KB/s %6.0f pkt/s  tx %8.1f KB/s %6.0f pkt/s  err %.0f/s drop %.0f/s  (%u ifaces)",
+                      s->net_iface, s->net_rx_bytes_per_s / 1024.0, s->net_rx_packets_per_s,
+                      s->net_tx_bytes_per_s / 1024.0, s->net_tx_packets_per_s,
+                      s->net_rx_errs_per_s + s->net_tx_errs_per_s, s->net_rx_drop_per_s + s->net_tx_drop_per_s,
+                      s->net_iface_count);
+
+    }
+
+    else screen_put(scr, r++, 0, "NET   N/A");
+
+    static const char* const psi_names[PSI_COUNT] = {"cpu", "mem", "io"};
+
+    char psi_line[256];
+    int len = snprintf(psi_line, sizeof(psi_line), "PSI   avg10/60/300");
+
+    for(int i = 0; i < PSI_COUNT; i++){
+
+        const PsiResource* p = &s->psi[i];
+
+        if(!p->available) continue;
+
+        len += snprintf(psi_line + len, sizeof(psi_line) - (size_t)len, "   %s some %.2f %.2f %.2f full %.2f",
+                        psi_names[i], p->some_avg10, p->some_avg60, p->some_avg300, p->full_avg10);
+
+        if(len >= (int)sizeof(psi_line)) break;
+
+    }
+
+    screen_put(scr, r++, 0, psi_line);
+
+    screen_printf(scr, r++, 0, "IRQ   %.0f/s  softirq %.0f/s  net_rx %.0f/s (imb %.2f)  hottest %s %.0f/s on cpu%d (imb %.2f)",
+                  s->irq.irq_total_per_s, s->irq.softirq_total_per_s, s->irq.net_rx_softirq_per_s,
+                  s->irq.net_rx_imbalance, s->irq.hottest_irq[0] ? s->irq.hottest_irq : "-",
+                  s->irq.hottest_irq_per_s, s->irq.hottest_irq_cpu, s->irq.irq_imbalance);
+
+    if(s->cgroup_count > 0){
+
+        const CgroupStats* c = &s->cgroup_top;
+
+        screen_printf(scr, r++, 0, "CGRP  %u tracked  busiest %s %.1f %%  mem %.1f MB  io r %.1f w %.1f KB/s  oom_kill %llu",
+                      s->cgroup_count, c->name, c->cpu_percent, (double)c->memory_current / (1024.0 * 1024.0),
+                      c->io_read_bytes_per_s / 1024.0, c->io_write_bytes_per_s / 1024.0, c->oom_kill);
+
+    }
+
+    else screen_put(scr, r++, 0, "CGRP  N/A");
+
+    r++;
+    r = draw_trends(scr, r);
+    r++;
+
+    // --- alerts ---
+    RuleAlert alerts[4];
+    size_t nalerts = rules_firing(alerts, sizeof(alerts) / sizeof(alerts[0]));
+
+    if(nalerts == 0) screen_printf(scr, r++, 0, "ALERTS  none firing (%zu rules)", rules_count());
+
+    uint64_t now = diag_now_ns();
+
+    for(size_t i = 0; i < nalerts; i++){
+
+        const RuleAlert* a = &alerts[i];
+        screen_printf(scr, r++, 0, "ALERT   %-20s %s %.2f %s %.2f   for %.0f s", a->name, a->field, a->value, a->op,
+                      a->threshold, (double)(now - a->since_ns) / 1e9);
+
+    }
+
+    r++;
+
+    // --- per-core bars, as many columns as fit ---
+    int per_row = cols / DASH_CORE_CELL;
+    if(per_row < 1) per_row = 1;
+
+    for(unsigned i = 0; i < s->core_count; i++){
+
+        int row = r + (int)(i / (unsigned)per_row);
+        int col = (int)(i % (unsigned)per_row) * DASH_CORE_CELL;
+
+        screen_printf(scr, row, col, "cpu%-3u", i);
+        screen_bar(scr, row, col + 6, 12, s->core_usage_percent[i]);
+        screen_printf(scr, row, col + 19, "%3.0f%%", s->core_usage_percent[i]);
+
+    }
+
+    if(s->core_count > 0) r += (int)((s->core_count + (unsigned)per_row - 1) / (unsigned)per_row);
+    r++;
+
+    r = draw_burst(scr, r, cols);
+    r = draw_fleet(scr, r, cols);
+
+    // --- top processes ---
+    screen_printf(scr, r++, 0, "%7s %-16s %7s %10s", "PID", "COMMAND", "CPU%", "RSS KB");
+
+    for(unsigned i = 0; i < s->top_proc_count; i++){
+
+        const ProcTopEntry* p = &s->top_procs[i];
+        screen_printf(scr, r++, 0, "%7d %-16s %7.1f %10ld", p->pid, p->comm, p->cpu_percent, p->rss_kb);
+
+    }
+
+    r++;
+
+    // --- monitor self-cost ---
+    DiagSummary sample, frame;
+    diag_summary(DIAG_SAMPLE, &sample);
+    diag_summary(DIAG_PAGE_RENDER, &frame);
+
+    screen_printf(scr, r++, 0, "self  sample p50 %.1f us p99 %.1f us   frame p50 %.1f us p99 %.1f us",
+                  (double)sample.p50_ns / 1e3, (double)sample.p99_ns / 1e3,
+                  (double)frame.p50_ns / 1e3, (double)frame.p99_ns / 1e3);
+
+    draw_schedule(scr, r++);
+
+    screen_put(scr, screen_rows(scr) - 1, 0, "Ctrl-C to quit, SIGUSR1 dumps timings");
+}
+
+/*
+ * Plain scrolling output for pipes and log files, where cursor movement
+ * would only produce garbage.
+ */
+static int display_stats_scrolling(HardwareStats* s){
+
+    while(!g_dash_stop){
 
             if(read_system_stats(s) != 0){
 
@@ -38,11 +423,91 @@ int display_stats_only_terminal(HardwareStats* s){
                 return 1;
             }
 
+            uint64_t t = diag_now_ns();
+            rules_evaluate(s, t);
+            diag_lap(DIAG_RULES, t);
+
             print_stats(s);
 
+            RuleAlert alerts[8];
+            size_t nalerts = rules_firing(alerts, sizeof(alerts) / sizeof(alerts[0]));
+
+            for(size_t i = 0; i < nalerts; i++){
+
+                printf("ALERT       : %s  %s %.2f %s %.2f\n", alerts[i].name, alerts[i].field, alerts[i].value,
+                       alerts[i].op, alerts[i].threshold);
+
+            }
+
+            printf("Monitor self-cost:\n");
+            diag_dump(stdout);
+
+            diag_poll_dump(stderr);
+
             sleep(1);
 
     }
 
     return 0;
-}
\ No newline at end of file
+}
+
+int display_stats_only_terminal(HardwareStats* s){
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_dash_signal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    if(!isatty(STDOUT_FILENO)) return display_stats_scrolling(s);
+
+    Screen* scr = NULL;
+
+    if(screen_init(&scr, STDOUT_FILENO) != 0){
+
+        fprintf(stderr, "screen_init failed!\n");
+        return 1;
+    }
+
+    int rc = 0;
+    memset(s, 0, sizeof(*s));
+
+    while(!g_dash_stop){
+
+        // collectors run on their own adaptive deadlines, frames on a fixed 10 Hz
+        int ran = read_due_stats(s, diag_now_ns());
+
+        if(ran < 0){
+
+            rc = 1;
+            break;
+        }
+
+        if(ran > 0){
+
+            uint64_t t = diag_now_ns();
+            rules_evaluate(s, t);
+            diag_lap(DIAG_RULES, t);
+
+        }
+
+        uint64_t t = diag_now_ns();
+        screen_begin_frame(scr);
+        draw_dashboard(scr, s);
+        screen_flush(scr);
+        diag_lap(DIAG_PAGE_RENDER, t);
+
+        // the dump lands on the same tty, repaint over it next frame
+        if(diag_poll_dump(stderr)) screen_invalidate(scr);
+
+        sleep_ms(DASH_FRAME_MS);
+
+    }
+
+    screen_deinit(scr);
+
+    if(rc != 0) fprintf(stderr, "read_system_stats failed!\n");
+
+    return rc;
+}